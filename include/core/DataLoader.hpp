@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <cstddef>
+#include <memory>
 #include <optional>
 
 struct Bar {
@@ -15,18 +17,39 @@ struct Bar {
     std::string symbol;
 };
 
+// Pull-style iterator over bars in fixed-size batches, for histories too
+// large to hold in memory at once.
+class BarStream {
+public:
+    virtual ~BarStream() = default;
+
+    // Replaces the contents of `chunk` with up to chunk_size() bars.
+    // Returns false once the stream is exhausted.
+    virtual bool next(std::vector<Bar>& chunk) = 0;
+    virtual std::size_t chunk_size() const = 0;
+};
+
 class DataLoader {
 public:
     virtual ~DataLoader() = default;
     virtual std::vector<Bar> load_file(const std::string& path,
                                        const std::string& symbol = "") = 0;
     virtual std::vector<Bar> load_dir(const std::string& dirpath) = 0;
+
+    virtual std::unique_ptr<BarStream> stream_file(const std::string& path,
+                                                   std::size_t chunk_size,
+                                                   const std::string& symbol = "") = 0;
+    virtual std::unique_ptr<BarStream> stream_dir(const std::string& dirpath,
+                                                  std::size_t chunk_size) = 0;
 };
 
 class CSVLoader : public DataLoader {
     char delimiter;
 
     std::chrono::system_clock::time_point parse_time(const std::string& ts) const;
+    Bar parse_line(const std::string& line, const std::string& symbol) const;
+
+    friend class CSVBarStream;
 
 public:
     explicit CSVLoader(char delim = ',') : delimiter(delim) {}
@@ -35,4 +58,13 @@ public:
                                const std::string& symbol = "") override;
 
     std::vector<Bar> load_dir(const std::string& dirpath) override;
+
+    std::unique_ptr<BarStream> stream_file(const std::string& path,
+                                           std::size_t chunk_size,
+                                           const std::string& symbol = "") override;
+
+    // Streams every .csv in the directory in path order, one file after
+    // another, with the file stem as the symbol.
+    std::unique_ptr<BarStream> stream_dir(const std::string& dirpath,
+                                          std::size_t chunk_size) override;
 };
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "core/DataLoader.hpp"
+#include "core/Resampler.hpp"
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <chrono>
+#include <cstddef>
+#include <deque>
 
 struct FeatureRow {
     std::chrono::system_clock::time_point timestamp;
@@ -32,5 +35,63 @@ public:
     static std::vector<double> atr(const std::vector<Bar>& bars, int window);
 
 
+    // One row per bar, computed by a fresh FeatureStream, so indicators
+    // restart whenever the bar symbol changes.
     static std::vector<FeatureRow> make_features(const std::vector<Bar>& bars);
+
+    // Adds the features of a higher timeframe (make_features over
+    // series.bars) to the base rows as "<prefix><name>", taking each base
+    // row's values from the latest higher bar closed by then. Values are
+    // NaN until the first higher bar closes. This copies every value into
+    // every base row, for models that need flat rows; AlignedFeatures
+    // reads the same values without copying.
+    static void join_timeframe(std::vector<FeatureRow>& base,
+                               const ResampledSeries& series,
+                               const std::vector<FeatureRow>& higher,
+                               const std::string& prefix);
+};
+
+// Lookup view over higher-timeframe rows (make_features over series.bars)
+// through the series alignment: at(i) is the row of the latest higher bar
+// closed by base bar i, or nullptr before the first one closes. Holds
+// pointers only; both arguments must outlive the view.
+class AlignedFeatures {
+public:
+    AlignedFeatures(const ResampledSeries& series, const std::vector<FeatureRow>& rows);
+
+    const FeatureRow* at(std::size_t base_index) const {
+        std::size_t j = series->align.at(base_index);
+        return j == ResampledSeries::npos ? nullptr : &(*rows)[j];
+    }
+
+    std::size_t size() const { return series->align.size(); }
+
+private:
+    const ResampledSeries* series;
+    const std::vector<FeatureRow>* rows;
+};
+
+// Incremental feature computation for chunked histories; make_features is
+// a single update over the whole history. Indicator warm-up state is
+// carried from one chunk into the next, so any chunking of a symbol's bars
+// yields the same rows. State restarts whenever the bar symbol changes.
+class FeatureStream {
+public:
+    // Replaces the contents of `out` with one row per bar in `chunk`.
+    void update(const std::vector<Bar>& chunk, std::vector<FeatureRow>& out);
+    void reset();
+
+private:
+    std::string symbol;
+    std::size_t count = 0;
+    double prev_close = 0.0;
+
+    std::deque<double> closes;
+    double rsi7_gain = 0, rsi7_loss = 0;
+    double rsi14_gain = 0, rsi14_loss = 0;
+    double rsi28_gain = 0, rsi28_loss = 0;
+    std::deque<double> rv24, rv48, rv72;
+    std::deque<double> bb20, sma50;
+    double ema12 = 0, ema26 = 0, macd_signal = 0;
+    std::deque<double> atr14;
 };
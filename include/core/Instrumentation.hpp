@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hot-path stages tracked by the instrumentation layer. Add new stages
+// before Count and give them a name in Instrumentation::stage_name.
+enum class Stage : std::size_t {
+    Request,
+    Marshal,
+    Features,
+    Fit,
+    Predict,
+    Count
+};
+
+struct StageSnapshot {
+    std::string name;
+    std::uint64_t calls;
+    std::uint64_t items;
+    std::uint64_t total_ns;
+    std::uint64_t max_ns;
+    std::uint64_t p50_ns;
+    std::uint64_t p90_ns;
+    std::uint64_t p99_ns;
+    std::uint64_t p999_ns;
+    std::uint64_t allocs;
+    std::uint64_t alloc_bytes;
+};
+
+// Log-linear latency histogram in the HDR style: every power of two is
+// split into 16 linear sub-buckets, so any recorded value is within ~6%
+// of its bucket bound. Recording is a single relaxed atomic increment.
+class LatencyHistogram {
+public:
+    static constexpr unsigned sub_bits = 4;
+    static constexpr std::size_t sub_count = std::size_t{1} << sub_bits;
+    static constexpr std::size_t bucket_count = (64 - sub_bits + 1) * sub_count;
+
+    void record(std::uint64_t value);
+    std::uint64_t percentile(double q) const;
+    void reset();
+
+    static std::size_t bucket_index(std::uint64_t value);
+    static std::uint64_t bucket_lower(std::size_t idx);
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets{};
+};
+
+struct StageStats {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> items{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> alloc_bytes{0};
+    LatencyHistogram latency;
+};
+
+class Instrumentation {
+public:
+    static constexpr bool enabled =
+#ifdef LA_INSTRUMENT
+        true;
+#else
+        false;
+#endif
+
+    static constexpr bool tracks_allocations =
+#ifdef LA_INSTRUMENT_ALLOCS
+        true;
+#else
+        false;
+#endif
+
+    static const char* stage_name(Stage s);
+
+    static StageStats& stats(Stage s);
+    static void record_time(Stage s, std::uint64_t ns);
+    static void add_items(Stage s, std::uint64_t n);
+    static void record_alloc(std::size_t bytes);
+
+    // Stage that allocations on this thread are currently attributed to,
+    // or nullptr outside any timed scope.
+    static StageStats*& current();
+
+    static std::vector<StageSnapshot> snapshot();
+    static void reset();
+};
+
+// Times the enclosing scope into the stage's histogram and, in
+// LA_INSTRUMENT_ALLOCS builds, attributes allocations made on this thread
+// to the stage until the scope exits. Time is inclusive of nested stages;
+// allocations are exclusive.
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(Stage s)
+        : stage(s),
+          prev(nullptr),
+          start(std::chrono::steady_clock::now()) {
+        if constexpr (Instrumentation::tracks_allocations) {
+            prev = Instrumentation::current();
+            Instrumentation::current() = &Instrumentation::stats(s);
+        }
+    }
+
+    ~ScopedStageTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if constexpr (Instrumentation::tracks_allocations) {
+            Instrumentation::current() = prev;
+        }
+        Instrumentation::record_time(
+            stage,
+            static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    Stage stage;
+    StageStats* prev;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define LA_CONCAT_IMPL(a, b) a##b
+#define LA_CONCAT(a, b) LA_CONCAT_IMPL(a, b)
+
+#ifdef LA_INSTRUMENT
+#define LA_SCOPED_STAGE(stage) \
+    ScopedStageTimer LA_CONCAT(la_stage_timer_, __LINE__)(stage)
+#define LA_COUNT_ITEMS(stage, n) \
+    Instrumentation::add_items((stage), static_cast<std::uint64_t>(n))
+#else
+#define LA_SCOPED_STAGE(stage) ((void)0)
+#define LA_COUNT_ITEMS(stage, n) ((void)0)
+#endif
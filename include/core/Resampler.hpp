@@ -0,0 +1,88 @@
+#pragma once
+
+#include "core/DataLoader.hpp"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Bars of one target timeframe, plus for every base bar fed in so far the
+// index of the latest bar here that had closed by the end of that base
+// bar. Lookups through the index (see AlignedFeatures) never reach an
+// unfinished bucket.
+struct ResampledSeries {
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::chrono::seconds interval;
+    std::vector<Bar> bars;
+    std::vector<std::size_t> align;
+};
+
+// Single-pass OHLCV aggregation of base bars into several timeframes at
+// once. Buckets are aligned to multiples of the timeframe from the epoch,
+// shifted by session_offset (e.g. 17:00 for FX daily sessions), and each
+// output bar is stamped with its bucket start. Empty buckets are skipped
+// rather than filled, and every bucket is closed when the symbol changes.
+// Timeframes must be distinct multiples of base, and session_offset a
+// multiple of base, so every bucket boundary falls on a base bar boundary.
+//
+// Works incrementally: a bucket closes as soon as a base bar reaching its
+// end arrives, or when the first bar of a later bucket arrives after a gap.
+// Bars of a symbol must have strictly increasing timestamps; a repeated
+// or late bar (e.g. a resent kline) is rejected without changing state.
+class Resampler {
+public:
+    Resampler(std::chrono::seconds base,
+              std::vector<std::chrono::seconds> timeframes,
+              std::chrono::seconds session_offset = std::chrono::seconds{0});
+
+    // Returns, per timeframe, how many bars this call closed; they are the
+    // last that many entries of series()[k].bars.
+    const std::vector<std::size_t>& update(const Bar& bar);
+
+    // Closes any unfinished buckets, e.g. at end of data, returning counts
+    // as update() does. Alignment of base bars already fed is unchanged.
+    const std::vector<std::size_t>& flush();
+
+    // Frees closed bars and alignment entries that have been consumed, so
+    // a live feed runs in bounded memory. Each series keeps only its
+    // latest closed bar of the current symbol, and open buckets carry on.
+    // Later alignment entries index the trimmed vectors.
+    void discard_emitted();
+
+    const std::vector<ResampledSeries>& series() const { return out; }
+
+    // In-progress bar of timeframe k, or nullptr between buckets.
+    const Bar* current(std::size_t k) const;
+
+    // Whole-history resampling. The trailing bucket is dropped unless the
+    // last bar completes it, since it never closed; feed an instance and
+    // call flush() to keep it.
+    static std::vector<ResampledSeries> resample(
+        const std::vector<Bar>& bars,
+        std::chrono::seconds base,
+        std::vector<std::chrono::seconds> timeframes,
+        std::chrono::seconds session_offset = std::chrono::seconds{0});
+
+private:
+    struct Bucket {
+        std::chrono::system_clock::time_point start;
+        bool open = false;
+        Bar partial;
+        std::size_t symbol_begin = 0;
+    };
+
+    std::chrono::seconds base;
+    std::chrono::seconds offset;
+    std::vector<Bucket> buckets;
+    std::vector<ResampledSeries> out;
+    std::vector<std::size_t> closed;
+    std::string symbol;
+    std::chrono::system_clock::time_point last_timestamp;
+    bool seen_any = false;
+
+    std::chrono::system_clock::time_point bucket_start(
+        std::chrono::system_clock::time_point ts, std::chrono::seconds interval) const;
+    void close(std::size_t k);
+    void close_all();
+};
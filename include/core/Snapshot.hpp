@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Binary snapshot layout (all fields native-endian, 8-byte aligned):
+//
+//   SnapshotHeader
+//   RecordHeader + body          (root record)
+//
+// A record body is a sequence of POD blocks, each padded to 8 bytes, and
+// may contain nested records. Because every block stays aligned relative
+// to the start of the file, a reader over a memory-mapped file can hand
+// out typed pointers straight into the mapping instead of parsing fields.
+
+constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+constexpr std::uint32_t SNAPSHOT_ENDIAN_TAG = 0x01020304;
+constexpr std::size_t SNAPSHOT_ALIGN = 8;
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian;
+    std::uint64_t payload_size;
+    std::uint64_t reserved;
+};
+
+struct RecordHeader {
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t size;
+};
+
+class SnapshotWriter {
+    std::vector<char> buf;
+    std::vector<std::size_t> open_records;
+
+    void pad();
+
+public:
+    SnapshotWriter();
+
+    void write_bytes(const void* p, std::size_t n);
+
+    template <typename T>
+    void write(const T& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(&v, sizeof(T));
+    }
+
+    template <typename T>
+    void write_array(const T* p, std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(p, n * sizeof(T));
+    }
+
+    // Count, offset table and one contiguous byte blob.
+    void write_strings(const std::vector<std::string>& strs);
+
+    void begin_record(std::uint32_t type);
+    void end_record();
+
+    const std::vector<char>& finish();
+    void save(const std::string& path);
+};
+
+class SnapshotReader {
+    const char* data;
+    std::size_t size;
+    std::size_t pos;
+    std::vector<std::size_t> record_ends;
+
+    std::size_t limit() const;
+
+public:
+    SnapshotReader(const char* data, std::size_t size);
+
+    const char* read_bytes(std::size_t n);
+
+    template <typename T>
+    const T& read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(alignof(T) <= SNAPSHOT_ALIGN);
+        return *reinterpret_cast<const T*>(read_bytes(sizeof(T)));
+    }
+
+    template <typename T>
+    const T* read_array(std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(alignof(T) <= SNAPSHOT_ALIGN);
+        if (n > limit() / sizeof(T)) {
+            throw std::runtime_error("Snapshot array exceeds record bounds");
+        }
+        return reinterpret_cast<const T*>(read_bytes(n * sizeof(T)));
+    }
+
+    std::vector<std::string> read_strings();
+
+    std::uint32_t peek_type() const;
+    void begin_record(std::uint32_t expected_type);
+    void end_record();
+};
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+    const char* ptr = nullptr;
+    std::size_t len = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* map_handle = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return ptr; }
+    std::size_t size() const { return len; }
+};
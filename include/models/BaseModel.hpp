@@ -1,15 +1,45 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include "core/FeatureEngine.hpp"
+#include "core/Snapshot.hpp"
+
+// Snapshot record tags. Values are part of the on-disk format; never reuse
+// or renumber them.
+enum class ModelType : std::uint32_t {
+    Linear = 1,
+    OnlineBoost = 2,
+    RegimeSwitch = 3,
+    Ridge = 4
+};
 
 class BaseModel {
 public:
+    BaseModel() = default;
+    // A copy gets its own lock: the lock guards an object, not its value.
+    BaseModel(const BaseModel&) {}
+    BaseModel& operator=(const BaseModel&) { return *this; }
     virtual ~BaseModel() = default;
     virtual void fit(const std::vector<FeatureRow>& X,
                      const std::vector<double>& y) = 0;
     virtual double predict(const FeatureRow& x) const = 0;
 
+    // Continues training on one more batch without revisiting earlier
+    // ones, so histories can be consumed in bounded memory.
+    virtual void partial_fit(const std::vector<FeatureRow>& X,
+                             const std::vector<double>& y) = 0;
+
+    // Marks the end of one full pass over the training history, for
+    // models whose schedule depends on passes rather than batches.
+    virtual void end_pass() {}
+
+    // Appends this model, including any nested models, as one record.
+    virtual void save(SnapshotWriter& w) const = 0;
+
     std::vector<double> predict(const std::vector<FeatureRow>& X) const {
         std::vector<double> out;
         out.reserve(X.size());
@@ -18,4 +48,24 @@ public:
         }
         return out;
     }
+
+    // Streams features chunk by chunk into partial_fit, labelling each bar
+    // with the next close of the same symbol, then calls end_pass. Memory
+    // stays proportional to the stream's chunk size regardless of history
+    // length, and the chunk size does not change the trained model.
+    void fit_stream(BarStream& stream);
+
+    void save(const std::string& path) const;
+
+    // Reads the next record, dispatching on its type tag.
+    static std::unique_ptr<BaseModel> load(SnapshotReader& r);
+    static std::unique_ptr<BaseModel> load(const std::string& path);
+
+    // For callers that share one model across threads, e.g. the Python
+    // bindings while fit_dir trains without the GIL. Models never take it
+    // themselves.
+    std::mutex& access_mutex() const { return access; }
+
+private:
+    mutable std::mutex access;
 };
@@ -2,6 +2,8 @@
 
 #include "core/FeatureEngine.hpp"
 #include "models/BaseModel.hpp"
+#include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -10,6 +12,7 @@ class LinearModel : public BaseModel {
 public:
 
     using BaseModel::predict;
+    using BaseModel::save;
 
     LinearModel(double lr = 0.01, int epochs = 100, double lambda = 0.0,
                 double decay = 0.0, bool logistic = false)
@@ -22,8 +25,31 @@ public:
     void fit(const std::vector<FeatureRow>& X,
              const std::vector<double>& y) override;
 
+    // One SGD sweep over the batch. Features not seen before start at zero
+    // weight. The learning rate decays with the number of completed passes
+    // (end_pass calls), so every batch of one pass uses the same rate.
+    void partial_fit(const std::vector<FeatureRow>& X,
+                     const std::vector<double>& y) override;
+
+    void end_pass() override { ++passes; }
+
     double predict(const FeatureRow& x) const override;
 
+    void save(SnapshotWriter& w) const override;
+    static std::unique_ptr<LinearModel> load(SnapshotReader& r);
+
+    // Fixed block at the start of the snapshot record, followed by
+    // n_weights doubles and the feature name table.
+    struct SnapshotParams {
+        double learning_rate;
+        double lambda;
+        double decay;
+        std::int32_t epochs;
+        std::uint32_t logistic;
+        std::uint64_t n_weights;
+        std::uint64_t passes;
+    };
+
 private:
     double learning_rate;
     int epochs;
@@ -34,4 +60,9 @@ private:
     std::vector<std::string> feature_names;
     std::unordered_map<std::string, std::size_t> feature_index;
     std::vector<double> weights;
+    std::uint64_t passes = 0;
+
+    void index_features(const std::vector<FeatureRow>& X);
+    void sgd_pass(const std::vector<FeatureRow>& X,
+                  const std::vector<double>& y, double lr);
 };
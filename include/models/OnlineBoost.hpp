@@ -2,6 +2,7 @@
 
 #include "models/BaseModel.hpp"
 #include "models/LinearModel.hpp"
+#include <memory>
 #include <vector>
 
 class OnlineBoost : public BaseModel {
@@ -13,9 +14,18 @@ public:
 
 
     using BaseModel::predict;
+    using BaseModel::save;
 
     void fit(const std::vector<FeatureRow>& X,
              const std::vector<double>& y) override;
 
+    void partial_fit(const std::vector<FeatureRow>& X,
+                     const std::vector<double>& y) override;
+
+    void end_pass() override;
+
     double predict(const FeatureRow& x) const override;
+
+    void save(SnapshotWriter& w) const override;
+    static std::unique_ptr<OnlineBoost> load(SnapshotReader& r);
 };
@@ -8,13 +8,28 @@ class RegimeSwitch : public BaseModel {
     std::unique_ptr<BaseModel> bear_model;
     double threshold;
 
+    void split(const std::vector<FeatureRow>& X, const std::vector<double>& y,
+               std::vector<FeatureRow>& bull_X, std::vector<double>& bull_y,
+               std::vector<FeatureRow>& bear_X, std::vector<double>& bear_y) const;
+
 public:
     RegimeSwitch(std::unique_ptr<BaseModel> bull,
                  std::unique_ptr<BaseModel> bear,
                  double thresh = 50.0);
 
+    using BaseModel::predict;
+    using BaseModel::save;
+
     void fit(const std::vector<FeatureRow>& X,
              const std::vector<double>& y) override;
 
+    void partial_fit(const std::vector<FeatureRow>& X,
+                     const std::vector<double>& y) override;
+
+    void end_pass() override;
+
     double predict(const FeatureRow& x) const override;
+
+    void save(SnapshotWriter& w) const override;
+    static std::unique_ptr<RegimeSwitch> load(SnapshotReader& r);
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/FeatureEngine.hpp"
+#include "models/BaseModel.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+// Closed-form ridge regression. Training only accumulates running means
+// and centred co-moments (Welford), so batches can be streamed through
+// partial_fit with memory proportional to the square of the feature count
+// rather than the number of rows. lambda penalises weights on features
+// standardised to unit variance, which keeps it meaningful for raw price
+// features; the intercept is not penalised. Weights are solved lazily on
+// the first predict or save after new data. NaN features count as zero.
+class RidgeModel : public BaseModel {
+public:
+
+    using BaseModel::predict;
+    using BaseModel::save;
+
+    explicit RidgeModel(double lambda = 1.0) : lambda(lambda) {}
+
+    void fit(const std::vector<FeatureRow>& X,
+             const std::vector<double>& y) override;
+
+    void partial_fit(const std::vector<FeatureRow>& X,
+                     const std::vector<double>& y) override;
+
+    double predict(const FeatureRow& x) const override;
+
+    void save(SnapshotWriter& w) const override;
+    static std::unique_ptr<RidgeModel> load(SnapshotReader& r);
+
+private:
+    double lambda;
+    std::uint64_t n_samples = 0;
+
+    std::vector<std::string> feature_names;
+    std::unordered_map<std::string, std::size_t> feature_index;
+
+    std::vector<double> mean_x;
+    double mean_y = 0.0;
+    // Row-major p x p upper triangle of sum((x - mean)(x - mean)').
+    std::vector<double> comoment;
+    std::vector<double> cross_y;
+
+    // Intercept first, then one weight per feature.
+    mutable std::vector<double> weights;
+    mutable std::atomic<bool> dirty{false};
+    mutable std::mutex solve_mutex;
+
+    void ensure_solved() const;
+    void solve() const;
+};
@@ -42,6 +42,20 @@ async def predict(symbol: str = Query(..., description="Trading pair symbol like
     return {"symbol": symbol.upper(), "prediction": prediction}
 
 
+@app.get("/stats")
+async def stats():
+    if cppmodel is None:
+        raise HTTPException(
+            status_code=500,
+            detail=f"cppmodel extension not available: {_CPPMODEL_IMPORT_ERROR}",
+        )
+    return {
+        "instrumentation_enabled": bool(cppmodel.instrumentation_enabled),
+        "allocation_tracking_enabled": bool(cppmodel.allocation_tracking_enabled),
+        "stages": cppmodel.stats(),
+    }
+
+
 @app.websocket("/ws/predict")
 async def ws_predict(websocket: WebSocket, symbol: str = Query(...)):
     await websocket.accept()
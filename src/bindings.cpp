@@ -3,34 +3,54 @@
 
 #include "core/DataLoader.hpp"
 #include "core/FeatureEngine.hpp"
+#include "core/Instrumentation.hpp"
+#include "core/Resampler.hpp"
+#include "models/BaseModel.hpp"
 #include "models/LinearModel.hpp"
+#include "models/OnlineBoost.hpp"
+#include "models/RegimeSwitch.hpp"
+#include "models/RidgeModel.hpp"
 
-namespace py = pybind11;
+#include <memory>
+#include <mutex>
 
-double predict_from_candles(const std::vector<std::vector<double>>& candles) {
-    std::size_t n = candles.size();
-    if (n < 2) {
-        throw std::runtime_error("Need at least 2 candles to train/predict");
-    }
+namespace py = pybind11;
 
+// fit_dir trains without the GIL, so other Python threads can reach the
+// same model meanwhile. Every binding that touches a model holds its
+// access_mutex, releasing the GIL before it blocks on it.
 
+// Candles are [open_time_ms, open, high, low, close, volume], as in
+// exchange kline responses. Taken as a raw Python sequence so that the
+// whole Python -> C++ conversion is timed as Marshal.
+static std::vector<Bar> candles_to_bars(const py::sequence& candles) {
+    LA_SCOPED_STAGE(Stage::Marshal);
+    std::size_t n = candles.size();
+    LA_COUNT_ITEMS(Stage::Marshal, n);
     std::vector<Bar> bars(n);
     for (std::size_t i = 0; i < n; ++i) {
+        py::object item = candles[i];
+        if (!py::isinstance<py::sequence>(item) || py::len(item) < 6) {
+            throw std::runtime_error("Each candle needs [time, open, high, low, close, volume]");
+        }
+        auto candle = item.cast<py::sequence>();
         Bar b{};
-        b.open   = candles[i][1];
-        b.high   = candles[i][2];
-        b.low    = candles[i][3];
-        b.close  = candles[i][4];
-        b.volume = candles[i][5];
+        b.open   = candle[1].cast<double>();
+        b.high   = candle[2].cast<double>();
+        b.low    = candle[3].cast<double>();
+        b.close  = candle[4].cast<double>();
+        b.volume = candle[5].cast<double>();
         b.symbol = "";
-        b.timestamp = std::chrono::system_clock::time_point{};
+        b.timestamp = std::chrono::system_clock::time_point{
+            std::chrono::milliseconds{static_cast<long long>(candle[0].cast<double>())}};
         bars[i] = b;
     }
+    return bars;
+}
 
-
+static std::vector<FeatureRow> clean_features(const std::vector<Bar>& bars) {
     auto feats = FeatureEngine::make_features(bars);
 
-
     for (auto &row : feats) {
         for (auto &kv : row.values) {
             if (std::isnan(kv.second) || std::isinf(kv.second)) {
@@ -38,14 +58,48 @@ double predict_from_candles(const std::vector<std::vector<double>>& candles) {
             }
         }
     }
+    return feats;
+}
 
-
-    std::vector<FeatureRow> X;
-    std::vector<double> y;
-    for (std::size_t i = 1; i < n; ++i) {
+// Pairs each feature row with the following bar's close.
+static void training_set(const std::vector<FeatureRow>& feats,
+                         const std::vector<Bar>& bars,
+                         std::vector<FeatureRow>& X,
+                         std::vector<double>& y) {
+    for (std::size_t i = 1; i < bars.size(); ++i) {
         X.push_back(feats[i - 1]);
         y.push_back(bars[i].close);
     }
+}
+
+// Deep copy through an in-memory snapshot, since Python cannot hand over
+// ownership of a model it holds.
+static std::unique_ptr<BaseModel> clone_model(const BaseModel& model) {
+    SnapshotWriter w;
+    {
+        py::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(model.access_mutex());
+        model.save(w);
+    }
+    const auto& bytes = w.finish();
+    SnapshotReader r(bytes.data(), bytes.size());
+    return BaseModel::load(r);
+}
+
+double predict_from_candles(const py::sequence& candles) {
+    LA_SCOPED_STAGE(Stage::Request);
+    std::size_t n = candles.size();
+    if (n < 2) {
+        throw std::runtime_error("Need at least 2 candles to train/predict");
+    }
+    LA_COUNT_ITEMS(Stage::Request, n);
+
+    auto bars = candles_to_bars(candles);
+    auto feats = clean_features(bars);
+
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    training_set(feats, bars, X, y);
 
     if (X.size() < 2) {
         return bars.back().close;
@@ -62,6 +116,134 @@ double predict_from_candles(const std::vector<std::vector<double>>& candles) {
 }
 
 PYBIND11_MODULE(cppmodel, m) {
-    m.doc() = "Bindings for the C++ LinearModel";
+    m.doc() = "Bindings for the C++ models";
     m.def("predict", &predict_from_candles, "Train on past candles and predict next close");
+
+    py::class_<BaseModel>(m, "BaseModel")
+        .def("fit", [](BaseModel& self, const py::sequence& candles) {
+            if (candles.size() < 3) {
+                throw std::runtime_error("Need at least 3 candles to train");
+            }
+            auto bars = candles_to_bars(candles);
+            auto feats = clean_features(bars);
+            std::vector<FeatureRow> X;
+            std::vector<double> y;
+            training_set(feats, bars, X, y);
+
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.access_mutex());
+            self.fit(X, y);
+        }, py::arg("candles"), "Train to predict each next close from past candles")
+        .def("fit_dir", [](BaseModel& self, const std::string& dirpath,
+                           std::size_t chunk_size, int passes) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.access_mutex());
+            CSVLoader loader;
+            for (int pass = 0; pass < passes; ++pass) {
+                auto stream = loader.stream_dir(dirpath, chunk_size);
+                self.fit_stream(*stream);
+            }
+        }, py::arg("dirpath"), py::arg("chunk_size") = 65536, py::arg("passes") = 1,
+           "Train out of core on every CSV in a directory, chunk_size bars at a time")
+        .def("predict", [](const BaseModel& self, const py::sequence& candles) {
+            if (candles.size() == 0) {
+                throw std::runtime_error("Need at least 1 candle to predict");
+            }
+            auto feats = clean_features(candles_to_bars(candles));
+
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.access_mutex());
+            return self.predict(feats.back());
+        }, py::arg("candles"), "Predict the close following the last candle")
+        .def("save", [](const BaseModel& self, const std::string& path) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.access_mutex());
+            self.save(path);
+        }, py::arg("path"), "Write a binary snapshot of the model");
+
+    py::class_<LinearModel, BaseModel>(m, "LinearModel")
+        .def(py::init<double, int, double, double, bool>(),
+             py::arg("lr") = 0.01, py::arg("epochs") = 100, py::arg("lambda_") = 0.0,
+             py::arg("decay") = 0.0, py::arg("logistic") = false);
+
+    py::class_<RidgeModel, BaseModel>(m, "RidgeModel")
+        .def(py::init<double>(), py::arg("lambda_") = 1.0);
+
+    py::class_<OnlineBoost, BaseModel>(m, "OnlineBoost")
+        .def(py::init<int, double, double>(),
+             py::arg("n_learners") = 3, py::arg("lr") = 0.01, py::arg("shrink") = 0.1);
+
+    py::class_<RegimeSwitch, BaseModel>(m, "RegimeSwitch")
+        .def(py::init([](const BaseModel& bull, const BaseModel& bear, double thresh) {
+                 return std::make_unique<RegimeSwitch>(clone_model(bull), clone_model(bear), thresh);
+             }),
+             py::arg("bull"), py::arg("bear"), py::arg("thresh") = 50.0,
+             "Regime model over copies of the given bull and bear models");
+
+    m.def("resample", [](const py::sequence& candles,
+                         long long base_seconds,
+                         const std::vector<long long>& timeframe_seconds,
+                         long long session_offset_seconds) {
+        auto bars = candles_to_bars(candles);
+        std::vector<std::chrono::seconds> timeframes;
+        for (auto tf : timeframe_seconds) timeframes.emplace_back(tf);
+
+        auto series = Resampler::resample(bars, std::chrono::seconds{base_seconds},
+                                          std::move(timeframes),
+                                          std::chrono::seconds{session_offset_seconds});
+
+        LA_SCOPED_STAGE(Stage::Marshal);
+        py::dict out;
+        for (const auto& s : series) {
+            std::vector<std::vector<double>> rows;
+            rows.reserve(s.bars.size());
+            for (const auto& b : s.bars) {
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    b.timestamp.time_since_epoch()).count();
+                rows.push_back({static_cast<double>(ms), b.open, b.high, b.low, b.close, b.volume});
+            }
+            std::vector<long long> align;
+            align.reserve(s.align.size());
+            for (auto j : s.align) {
+                align.push_back(j == ResampledSeries::npos ? -1 : static_cast<long long>(j));
+            }
+
+            py::dict d;
+            d["candles"] = rows;
+            d["align"] = align;
+            out[py::int_(s.interval.count())] = d;
+        }
+        return out;
+    }, py::arg("candles"), py::arg("base_seconds"), py::arg("timeframes"),
+       py::arg("session_offset") = 0,
+       "Aggregate candles into several distinct timeframes in one pass, keyed "
+       "by interval; align[i] is the latest closed higher candle for base "
+       "candle i, or -1. A trailing unfinished candle is not included");
+
+    m.def("load", [](const std::string& path) {
+        return BaseModel::load(path);
+    }, py::arg("path"), "Memory-map a model snapshot written by BaseModel.save");
+
+    m.attr("instrumentation_enabled") = Instrumentation::enabled;
+    m.attr("allocation_tracking_enabled") = Instrumentation::tracks_allocations;
+    m.def("stats", []() {
+        py::dict out;
+        for (const auto& s : Instrumentation::snapshot()) {
+            py::dict d;
+            d["calls"]       = s.calls;
+            d["items"]       = s.items;
+            d["total_ns"]    = s.total_ns;
+            d["max_ns"]      = s.max_ns;
+            d["p50_ns"]      = s.p50_ns;
+            d["p90_ns"]      = s.p90_ns;
+            d["p99_ns"]      = s.p99_ns;
+            d["p999_ns"]     = s.p999_ns;
+            d["allocs"]      = s.allocs;
+            d["alloc_bytes"] = s.alloc_bytes;
+            out[py::str(s.name)] = d;
+        }
+        return out;
+    }, "Per-stage latency, counter and allocation snapshot (empty when instrumentation is compiled out; "
+       "allocation fields stay zero unless built with LA_INSTRUMENT_ALLOCS)");
+    m.def("reset_stats", &Instrumentation::reset, "Clear all instrumentation counters");
 }
@@ -33,6 +33,27 @@ chrono::system_clock::time_point CSVLoader::parse_time(const string& ts) const {
 #endif
 }
 
+Bar CSVLoader::parse_line(const string& line, const string& symbol) const {
+    stringstream ss(line);
+    string ts, o, h, l, c, v;
+    getline(ss, ts, delimiter);
+    getline(ss, o, delimiter);
+    getline(ss, h, delimiter);
+    getline(ss, l, delimiter);
+    getline(ss, c, delimiter);
+    getline(ss, v, delimiter);
+
+    Bar b;
+    b.timestamp = parse_time(ts);
+    b.open   = stod(o);
+    b.high   = stod(h);
+    b.low    = stod(l);
+    b.close  = stod(c);
+    b.volume = stod(v);
+    b.symbol = symbol;
+    return b;
+}
+
 vector<Bar> CSVLoader::load_file(const string& path, const string& symbol) {
     ifstream file(path);
     if (!file.is_open()) throw runtime_error("Could not open " + path);
@@ -40,31 +61,14 @@ vector<Bar> CSVLoader::load_file(const string& path, const string& symbol) {
     vector<Bar> bars;
     string line;
     bool header_skipped = false;
+    const string& sym = symbol.empty() ? path : symbol;
 
     while (getline(file, line)) {
         if (!header_skipped) {
             header_skipped = true;
             continue;
         }
-        stringstream ss(line);
-        string ts, o, h, l, c, v;
-        getline(ss, ts, delimiter);
-        getline(ss, o, delimiter);
-        getline(ss, h, delimiter);
-        getline(ss, l, delimiter);
-        getline(ss, c, delimiter);
-        getline(ss, v, delimiter);
-
-        Bar b;
-        b.timestamp = parse_time(ts);
-        b.open   = stod(o);
-        b.high   = stod(h);
-        b.low    = stod(l);
-        b.close  = stod(c);
-        b.volume = stod(v);
-        b.symbol = symbol.empty() ? path : symbol;
-
-        bars.push_back(b);
+        bars.push_back(parse_line(line, sym));
     }
 
     return bars;
@@ -81,3 +85,71 @@ vector<Bar> CSVLoader::load_dir(const string& dirpath) {
     }
     return all_bars;
 }
+
+
+// Reads one CSV file at a time, holding only the open stream and the
+// caller's chunk buffer in memory.
+class CSVBarStream : public BarStream {
+    CSVLoader loader;
+    size_t chunk;
+    vector<pair<string, string>> files;
+    size_t next_file = 0;
+    ifstream current;
+    string current_symbol;
+
+    bool open_next() {
+        while (next_file < files.size()) {
+            const auto& [path, symbol] = files[next_file++];
+            current = ifstream(path);
+            if (!current.is_open()) throw runtime_error("Could not open " + path);
+
+            string header;
+            if (getline(current, header)) {
+                current_symbol = symbol;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    CSVBarStream(const CSVLoader& loader, size_t chunk_size,
+                 vector<pair<string, string>> files)
+        : loader(loader), chunk(chunk_size), files(std::move(files)) {
+        if (chunk == 0) throw invalid_argument("chunk_size must be positive");
+        open_next();
+    }
+
+    bool next(vector<Bar>& out) override {
+        out.clear();
+        string line;
+        while (out.size() < chunk && current.is_open()) {
+            if (getline(current, line)) {
+                out.push_back(loader.parse_line(line, current_symbol));
+            } else {
+                current.close();
+                open_next();
+            }
+        }
+        return !out.empty();
+    }
+
+    size_t chunk_size() const override { return chunk; }
+};
+
+unique_ptr<BarStream> CSVLoader::stream_file(const string& path, size_t chunk_size,
+                                             const string& symbol) {
+    return make_unique<CSVBarStream>(*this, chunk_size,
+                                     vector<pair<string, string>>{{path, symbol.empty() ? path : symbol}});
+}
+
+unique_ptr<BarStream> CSVLoader::stream_dir(const string& dirpath, size_t chunk_size) {
+    vector<pair<string, string>> files;
+    for (const auto& entry : filesystem::directory_iterator(dirpath)) {
+        if (entry.path().extension() == ".csv") {
+            files.emplace_back(entry.path().string(), entry.path().stem().string());
+        }
+    }
+    sort(files.begin(), files.end());
+    return make_unique<CSVBarStream>(*this, chunk_size, std::move(files));
+}
@@ -1,4 +1,6 @@
 #include "core/FeatureEngine.hpp"
+#include "core/Instrumentation.hpp"
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <deque>
@@ -10,6 +12,89 @@ static double mean(const std::deque<double>& window) {
 }
 
 
+// Per-bar steps shared by the whole-series functions below and by
+// FeatureStream, so batch and incremental features cannot drift apart.
+
+static void push_window(std::deque<double>& win, double x, int window) {
+    win.push_back(x);
+    if (win.size() > (size_t)window) win.pop_front();
+}
+
+static double sma_step(std::deque<double>& win, double x, int window) {
+    push_window(win, x, window);
+    return win.size() == (size_t)window ? mean(win) : NAN;
+}
+
+static double stddev(const std::deque<double>& win, double m) {
+    double sq_sum = std::inner_product(win.begin(), win.end(), win.begin(), 0.0);
+    double variance = (sq_sum / win.size()) - (m * m);
+    return std::sqrt(std::max(variance, 0.0));
+}
+
+static double vol_step(std::deque<double>& win, double ret, int window) {
+    push_window(win, ret, window);
+    if (win.size() != (size_t)window) return NAN;
+    return stddev(win, mean(win));
+}
+
+static void bollinger_step(std::deque<double>& win, double x, int window, double k,
+                           double& mid, double& upper, double& lower,
+                           double& pctb, double& bandwidth) {
+    push_window(win, x, window);
+    if (win.size() != (size_t)window) {
+        mid = upper = lower = pctb = bandwidth = NAN;
+        return;
+    }
+    double m = mean(win);
+    double sd = stddev(win, m);
+
+    mid = m;
+    upper = m + k * sd;
+    lower = m - k * sd;
+    pctb = (x - lower) / (upper - lower);
+    bandwidth = (upper - lower) / (m != 0 ? m : 1.0);
+}
+
+static double rsi_step(double delta, size_t i, int window, double& avg_gain, double& avg_loss) {
+    double gain = std::max(delta, 0.0);
+    double loss = std::max(-delta, 0.0);
+
+    if (i < (size_t)window) {
+        avg_gain += gain;
+        avg_loss += loss;
+        return NAN;
+    }
+
+    if (i == (size_t)window) {
+        avg_gain /= window;
+        avg_loss /= window;
+    } else {
+        avg_gain = (avg_gain * (window - 1) + gain) / window;
+        avg_loss = (avg_loss * (window - 1) + loss) / window;
+    }
+
+    double rs = (avg_loss == 0) ? 0 : avg_gain / avg_loss;
+    return 100.0 - (100.0 / (1.0 + rs));
+}
+
+static double ema_step(double prev, double x, size_t i, int window) {
+    if (i == 0) return x;
+    double alpha = 2.0 / (window + 1);
+    return alpha * x + (1 - alpha) * prev;
+}
+
+static double true_range(const Bar& bar, double prev_close) {
+    return std::max({bar.high - bar.low,
+                     std::fabs(bar.high - prev_close),
+                     std::fabs(bar.low - prev_close)});
+}
+
+static double range_frac_step(const Bar& bar) {
+    double rng = bar.high - bar.low;
+    return rng > 0 ? (bar.close - bar.low) / rng : NAN;
+}
+
+
 std::vector<double> FeatureEngine::returns(const std::vector<double>& closes, int lag) {
     std::vector<double> out(closes.size(), NAN);
     for (size_t i = lag; i < closes.size(); i++) {
@@ -21,28 +106,8 @@ std::vector<double> FeatureEngine::returns(const std::vector<double>& closes, in
 std::vector<double> FeatureEngine::rsi(const std::vector<double>& closes, int window) {
     std::vector<double> out(closes.size(), NAN);
     double avg_gain = 0, avg_loss = 0;
-
     for (size_t i = 1; i < closes.size(); i++) {
-        double delta = closes[i] - closes[i - 1];
-        double gain = std::max(delta, 0.0);
-        double loss = std::max(-delta, 0.0);
-
-        if (i < (size_t)window) {
-            avg_gain += gain;
-            avg_loss += loss;
-            continue;
-        }
-
-        if (i == (size_t)window) {
-            avg_gain /= window;
-            avg_loss /= window;
-        } else {
-            avg_gain = (avg_gain * (window - 1) + gain) / window;
-            avg_loss = (avg_loss * (window - 1) + loss) / window;
-        }
-
-        double rs = (avg_loss == 0) ? 0 : avg_gain / avg_loss;
-        out[i] = 100.0 - (100.0 / (1.0 + rs));
+        out[i] = rsi_step(closes[i] - closes[i - 1], i, window, avg_gain, avg_loss);
     }
     return out;
 }
@@ -54,211 +119,197 @@ void FeatureEngine::bollinger(const std::vector<double>& closes, int window, dou
                               std::vector<double>& pctb,
                               std::vector<double>& bandwidth) {
     size_t n = closes.size();
-    mid.assign(n, NAN);
-    upper.assign(n, NAN);
-    lower.assign(n, NAN);
-    pctb.assign(n, NAN);
-    bandwidth.assign(n, NAN);
+    mid.resize(n);
+    upper.resize(n);
+    lower.resize(n);
+    pctb.resize(n);
+    bandwidth.resize(n);
 
     std::deque<double> win;
     for (size_t i = 0; i < n; i++) {
-        win.push_back(closes[i]);
-        if (win.size() > (size_t)window) win.pop_front();
-
-        if (win.size() == (size_t)window) {
-            double m = mean(win);
-            double sq_sum = std::inner_product(win.begin(), win.end(), win.begin(), 0.0);
-            double variance = (sq_sum / window) - (m * m);
-            double stddev = std::sqrt(std::max(variance, 0.0));
-
-            mid[i] = m;
-            upper[i] = m + k * stddev;
-            lower[i] = m - k * stddev;
-            pctb[i] = (closes[i] - lower[i]) / (upper[i] - lower[i]);
-            bandwidth[i] = (upper[i] - lower[i]) / (m != 0 ? m : 1.0);
-        }
+        bollinger_step(win, closes[i], window, k, mid[i], upper[i], lower[i], pctb[i], bandwidth[i]);
     }
 }
 
 std::vector<double> FeatureEngine::realized_vol(const std::vector<double>& closes, int window) {
     std::vector<double> out(closes.size(), NAN);
     std::deque<double> win;
-
     for (size_t i = 1; i < closes.size(); i++) {
-        double ret = (closes[i] - closes[i - 1]) / closes[i - 1];
-        win.push_back(ret);
-        if (win.size() > (size_t)window) win.pop_front();
-
-        if (win.size() == (size_t)window) {
-            double m = mean(win);
-            double sq_sum = std::inner_product(win.begin(), win.end(), win.begin(), 0.0);
-            double variance = (sq_sum / window) - (m * m);
-            out[i] = std::sqrt(std::max(variance, 0.0));
-        }
+        out[i] = vol_step(win, (closes[i] - closes[i - 1]) / closes[i - 1], window);
     }
     return out;
 }
 
 std::vector<double> FeatureEngine::range_frac(const std::vector<Bar>& bars) {
-    std::vector<double> out(bars.size(), NAN);
+    std::vector<double> out(bars.size());
     for (size_t i = 0; i < bars.size(); i++) {
-        double rng = bars[i].high - bars[i].low;
-        if (rng > 0) {
-            out[i] = (bars[i].close - bars[i].low) / rng;
-        }
+        out[i] = range_frac_step(bars[i]);
     }
     return out;
 }
 
 
-
-
-
-
 std::vector<double> FeatureEngine::ema(const std::vector<double>& closes, int window) {
     std::vector<double> out(closes.size(), NAN);
-    if (closes.empty()) return out;
-    double alpha = 2.0 / (window + 1);
-    out[0] = closes[0];
-    for (size_t i = 1; i < closes.size(); i++) {
-        out[i] = alpha * closes[i] + (1 - alpha) * out[i - 1];
+    for (size_t i = 0; i < closes.size(); i++) {
+        out[i] = ema_step(i > 0 ? out[i - 1] : 0.0, closes[i], i, window);
     }
     return out;
 }
 
-
 std::vector<double> FeatureEngine::sma(const std::vector<double>& closes, int window) {
-    std::vector<double> out(closes.size(), NAN);
+    std::vector<double> out(closes.size());
     std::deque<double> win;
     for (size_t i = 0; i < closes.size(); i++) {
-        win.push_back(closes[i]);
-        if (win.size() > (size_t)window) win.pop_front();
-        if (win.size() == (size_t)window) {
-            out[i] = mean(win);
-        }
+        out[i] = sma_step(win, closes[i], window);
     }
     return out;
 }
 
-
 std::vector<double> FeatureEngine::atr(const std::vector<Bar>& bars, int window) {
     std::vector<double> out(bars.size(), NAN);
     std::deque<double> win;
     for (size_t i = 1; i < bars.size(); i++) {
-        double tr = std::max({bars[i].high - bars[i].low,
-                              std::fabs(bars[i].high - bars[i - 1].close),
-                              std::fabs(bars[i].low - bars[i - 1].close)});
-        win.push_back(tr);
-        if (win.size() > (size_t)window) win.pop_front();
-        if (win.size() == (size_t)window) {
-            out[i] = mean(win);
-        }
+        out[i] = sma_step(win, true_range(bars[i], bars[i - 1].close), window);
     }
     return out;
 }
 
 
-
-
-
 std::vector<FeatureRow> FeatureEngine::make_features(const std::vector<Bar>& bars) {
     std::vector<FeatureRow> features;
-    size_t n = bars.size();
-    std::vector<double> closes(n);
-    for (size_t i = 0; i < n; i++) closes[i] = bars[i].close;
-
-
-    auto ret1  = returns(closes, 1);
-    auto ret5  = returns(closes, 5);
-    auto ret10 = returns(closes, 10);
-    auto ret20 = returns(closes, 20);
-
-
-    auto rsi7  = rsi(closes, 7);
-    auto rsi14 = rsi(closes, 14);
-    auto rsi28 = rsi(closes, 28);
-
-
-    auto rv24 = realized_vol(closes, 24);
-    auto rv48 = realized_vol(closes, 48);
-    auto rv72 = realized_vol(closes, 72);
-
-
-    auto rangeF = range_frac(bars);
-
-
-    std::vector<double> bb20_mid, bb20_upper, bb20_lower, bb20_pctb, bb20_bw;
-    bollinger(closes, 20, 2.0, bb20_mid, bb20_upper, bb20_lower, bb20_pctb, bb20_bw);
+    FeatureStream().update(bars, features);
+    return features;
+}
 
 
-    auto sma20 = sma(closes, 20);
-    auto sma50 = sma(closes, 50);
-    auto ema12 = ema(closes, 12);
-    auto ema26 = ema(closes, 26);
+AlignedFeatures::AlignedFeatures(const ResampledSeries& series,
+                                 const std::vector<FeatureRow>& rows)
+    : series(&series), rows(&rows) {
+    if (rows.size() != series.bars.size()) {
+        throw std::invalid_argument("Higher-timeframe rows do not match the series bars");
+    }
+}
 
+void FeatureEngine::join_timeframe(std::vector<FeatureRow>& base,
+                                   const ResampledSeries& series,
+                                   const std::vector<FeatureRow>& higher,
+                                   const std::string& prefix) {
+    if (series.align.size() != base.size()) {
+        throw std::invalid_argument("Alignment does not match the base rows");
+    }
+    AlignedFeatures view(series, higher);
+    if (higher.empty()) return;
 
-    std::vector<double> macd(n, NAN), macd_signal(n, NAN), macd_hist(n, NAN);
-    for (size_t i = 0; i < n; i++) {
-        if (!std::isnan(ema12[i]) && !std::isnan(ema26[i])) {
-            macd[i] = ema12[i] - ema26[i];
-        }
+    std::vector<std::pair<std::string, std::string>> names;
+    for (const auto& kv : higher.front().values) {
+        names.emplace_back(kv.first, prefix + kv.first);
     }
 
-    macd_signal = ema(macd, 9);
-    for (size_t i = 0; i < n; i++) {
-        if (!std::isnan(macd[i]) && !std::isnan(macd_signal[i])) {
-            macd_hist[i] = macd[i] - macd_signal[i];
+    for (size_t i = 0; i < base.size(); i++) {
+        const FeatureRow* h = view.at(i);
+        for (const auto& [name, joined] : names) {
+            double v = NAN;
+            if (h) {
+                auto it = h->values.find(name);
+                if (it != h->values.end()) v = it->second;
+            }
+            base[i].values[joined] = v;
         }
     }
+}
 
 
-    auto atr14 = atr(bars, 14);
-
-
-    for (size_t i = 0; i < n; i++) {
-        FeatureRow row;
-        row.timestamp = bars[i].timestamp;
-        row.symbol = bars[i].symbol;
+void FeatureStream::reset() {
+    *this = FeatureStream();
+}
 
+void FeatureStream::update(const std::vector<Bar>& chunk, std::vector<FeatureRow>& out) {
+    LA_SCOPED_STAGE(Stage::Features);
+    LA_COUNT_ITEMS(Stage::Features, chunk.size());
+    out.clear();
+    out.reserve(chunk.size());
+
+    for (const auto& bar : chunk) {
+        if (count > 0 && bar.symbol != symbol) reset();
+        symbol = bar.symbol;
+
+        const size_t i = count++;
+        const double c = bar.close;
+        push_window(closes, c, 21);
+
+        auto ret = [&](size_t lag) {
+            if (i < lag) return (double)NAN;
+            double past = closes[closes.size() - 1 - lag];
+            return (c - past) / past;
+        };
+
+        double rsi7 = NAN, rsi14 = NAN, rsi28 = NAN;
+        double rv24 = NAN, rv48 = NAN, rv72 = NAN;
+        double atr = NAN;
+        if (i >= 1) {
+            double delta = c - prev_close;
+            rsi7  = rsi_step(delta, i, 7,  rsi7_gain,  rsi7_loss);
+            rsi14 = rsi_step(delta, i, 14, rsi14_gain, rsi14_loss);
+            rsi28 = rsi_step(delta, i, 28, rsi28_gain, rsi28_loss);
+
+            double r = (c - prev_close) / prev_close;
+            rv24 = vol_step(this->rv24, r, 24);
+            rv48 = vol_step(this->rv48, r, 48);
+            rv72 = vol_step(this->rv72, r, 72);
+
+            atr = sma_step(atr14, true_range(bar, prev_close), 14);
+        }
 
-        row.values["ret_1"]  = ret1[i];
-        row.values["ret_5"]  = ret5[i];
-        row.values["ret_10"] = ret10[i];
-        row.values["ret_20"] = ret20[i];
+        double mid, upper, lower, pctb, bw;
+        bollinger_step(bb20, c, 20, 2.0, mid, upper, lower, pctb, bw);
+        double sma20 = bb20.size() == 20 ? mean(bb20) : NAN;
+        double sma50v = sma_step(sma50, c, 50);
 
+        ema12 = ema_step(ema12, c, i, 12);
+        ema26 = ema_step(ema26, c, i, 26);
+        double macd = (!std::isnan(ema12) && !std::isnan(ema26)) ? ema12 - ema26 : NAN;
+        macd_signal = ema_step(macd_signal, macd, i, 9);
+        double macd_hist = (!std::isnan(macd) && !std::isnan(macd_signal)) ? macd - macd_signal : NAN;
 
-        row.values["rsi7"]  = rsi7[i];
-        row.values["rsi14"] = rsi14[i];
-        row.values["rsi28"] = rsi28[i];
+        prev_close = c;
 
+        FeatureRow row;
+        row.timestamp = bar.timestamp;
+        row.symbol = bar.symbol;
 
-        row.values["rv_24"] = rv24[i];
-        row.values["rv_48"] = rv48[i];
-        row.values["rv_72"] = rv72[i];
+        row.values["ret_1"]  = ret(1);
+        row.values["ret_5"]  = ret(5);
+        row.values["ret_10"] = ret(10);
+        row.values["ret_20"] = ret(20);
 
+        row.values["rsi7"]  = rsi7;
+        row.values["rsi14"] = rsi14;
+        row.values["rsi28"] = rsi28;
 
-        row.values["range_frac"] = rangeF[i];
+        row.values["rv_24"] = rv24;
+        row.values["rv_48"] = rv48;
+        row.values["rv_72"] = rv72;
 
+        row.values["range_frac"] = range_frac_step(bar);
 
-        row.values["bb20_mid"]   = bb20_mid[i];
-        row.values["bb20_upper"] = bb20_upper[i];
-        row.values["bb20_lower"] = bb20_lower[i];
-        row.values["bb20_pctb"]  = bb20_pctb[i];
-        row.values["bb20_bw"]    = bb20_bw[i];
+        row.values["bb20_mid"]   = mid;
+        row.values["bb20_upper"] = upper;
+        row.values["bb20_lower"] = lower;
+        row.values["bb20_pctb"]  = pctb;
+        row.values["bb20_bw"]    = bw;
 
-        row.values["sma20"] = sma20[i];
-        row.values["sma50"] = sma50[i];
-        row.values["ema12"] = ema12[i];
-        row.values["ema26"] = ema26[i];
+        row.values["sma20"] = sma20;
+        row.values["sma50"] = sma50v;
+        row.values["ema12"] = ema12;
+        row.values["ema26"] = ema26;
 
-        row.values["macd"]       = macd[i];
-        row.values["macd_signal"]= macd_signal[i];
-        row.values["macd_hist"]  = macd_hist[i];
+        row.values["macd"]       = macd;
+        row.values["macd_signal"]= macd_signal;
+        row.values["macd_hist"]  = macd_hist;
 
-        row.values["atr14"] = atr14[i];
+        row.values["atr14"] = atr;
 
-        features.push_back(row);
+        out.push_back(std::move(row));
     }
-
-    return features;
 }
@@ -0,0 +1,181 @@
+#include "core/Instrumentation.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::array<StageStats, static_cast<std::size_t>(Stage::Count)>& all_stats() {
+    static std::array<StageStats, static_cast<std::size_t>(Stage::Count)> s;
+    return s;
+}
+
+}
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value) {
+    if (value < sub_count) return static_cast<std::size_t>(value);
+    unsigned msb = 63u - static_cast<unsigned>(std::countl_zero(value));
+    std::size_t sub = static_cast<std::size_t>((value >> (msb - sub_bits)) & (sub_count - 1));
+    return (msb - sub_bits + 1) * sub_count + sub;
+}
+
+std::uint64_t LatencyHistogram::bucket_lower(std::size_t idx) {
+    if (idx < sub_count) return idx;
+    unsigned msb = static_cast<unsigned>(idx / sub_count) + sub_bits - 1;
+    std::uint64_t sub = idx % sub_count;
+    return (sub_count + sub) << (msb - sub_bits);
+}
+
+void LatencyHistogram::record(std::uint64_t value) {
+    buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const {
+    std::uint64_t total = 0;
+    for (const auto& b : buckets) total += b.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    auto target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+    target = std::clamp<std::uint64_t>(target, 1, total);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            // Report the highest value equivalent to this bucket.
+            return i + 1 < bucket_count ? bucket_lower(i + 1) - 1 : UINT64_MAX;
+        }
+    }
+    return UINT64_MAX;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+}
+
+const char* Instrumentation::stage_name(Stage s) {
+    switch (s) {
+        case Stage::Request:  return "request";
+        case Stage::Marshal:  return "marshal";
+        case Stage::Features: return "features";
+        case Stage::Fit:      return "fit";
+        case Stage::Predict:  return "predict";
+        default:              return "unknown";
+    }
+}
+
+StageStats& Instrumentation::stats(Stage s) {
+    return all_stats()[static_cast<std::size_t>(s)];
+}
+
+StageStats*& Instrumentation::current() {
+    thread_local StageStats* cur = nullptr;
+    return cur;
+}
+
+void Instrumentation::record_time(Stage s, std::uint64_t ns) {
+    auto& st = stats(s);
+    st.calls.fetch_add(1, std::memory_order_relaxed);
+    st.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t prev = st.max_ns.load(std::memory_order_relaxed);
+    while (prev < ns &&
+           !st.max_ns.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+    st.latency.record(ns);
+}
+
+void Instrumentation::add_items(Stage s, std::uint64_t n) {
+    stats(s).items.fetch_add(n, std::memory_order_relaxed);
+}
+
+void Instrumentation::record_alloc(std::size_t bytes) {
+    StageStats* st = current();
+    if (!st) return;
+    st->allocs.fetch_add(1, std::memory_order_relaxed);
+    st->alloc_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+std::vector<StageSnapshot> Instrumentation::snapshot() {
+    std::vector<StageSnapshot> out;
+    if (!enabled) return out;
+
+    out.reserve(static_cast<std::size_t>(Stage::Count));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Stage::Count); ++i) {
+        auto s = static_cast<Stage>(i);
+        const auto& st = stats(s);
+        StageSnapshot snap{};
+        snap.name        = stage_name(s);
+        snap.calls       = st.calls.load(std::memory_order_relaxed);
+        snap.items       = st.items.load(std::memory_order_relaxed);
+        snap.total_ns    = st.total_ns.load(std::memory_order_relaxed);
+        snap.max_ns      = st.max_ns.load(std::memory_order_relaxed);
+        snap.p50_ns      = std::min(st.latency.percentile(0.50), snap.max_ns);
+        snap.p90_ns      = std::min(st.latency.percentile(0.90), snap.max_ns);
+        snap.p99_ns      = std::min(st.latency.percentile(0.99), snap.max_ns);
+        snap.p999_ns     = std::min(st.latency.percentile(0.999), snap.max_ns);
+        snap.allocs      = st.allocs.load(std::memory_order_relaxed);
+        snap.alloc_bytes = st.alloc_bytes.load(std::memory_order_relaxed);
+        out.push_back(snap);
+    }
+    return out;
+}
+
+void Instrumentation::reset() {
+    for (auto& st : all_stats()) {
+        st.calls.store(0, std::memory_order_relaxed);
+        st.items.store(0, std::memory_order_relaxed);
+        st.total_ns.store(0, std::memory_order_relaxed);
+        st.max_ns.store(0, std::memory_order_relaxed);
+        st.allocs.store(0, std::memory_order_relaxed);
+        st.alloc_bytes.store(0, std::memory_order_relaxed);
+        st.latency.reset();
+    }
+}
+
+#ifdef LA_INSTRUMENT_ALLOCS
+
+// Replacing the global allocation functions lets every allocation made
+// inside a timed scope be charged to that stage. libstdc++ declares them
+// with default visibility, so -fvisibility=hidden does not contain them:
+// they are exported from whichever binary links this file and take part in
+// ordinary dynamic symbol resolution. In the executable they replace the
+// allocator for the whole process; in the extension module they may also
+// serve other code resolving through the module's scope, which is why this
+// is a separate opt-in build. Every allocation pays a TLS read and, inside
+// a stage, two relaxed atomic adds.
+
+void* operator new(std::size_t size) {
+    Instrumentation::record_alloc(size);
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler h = std::get_new_handler();
+        if (!h) throw std::bad_alloc();
+        h();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
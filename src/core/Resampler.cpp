@@ -0,0 +1,138 @@
+#include "core/Resampler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+Resampler::Resampler(std::chrono::seconds base,
+                     std::vector<std::chrono::seconds> timeframes,
+                     std::chrono::seconds session_offset)
+    : base(base), offset(session_offset) {
+    if (base.count() <= 0) {
+        throw std::invalid_argument("Base interval must be positive");
+    }
+    if (session_offset.count() % base.count() != 0) {
+        throw std::invalid_argument("Session offset must be a whole multiple of the base interval");
+    }
+    for (std::size_t k = 0; k < timeframes.size(); ++k) {
+        auto tf = timeframes[k];
+        if (tf < base || tf.count() % base.count() != 0) {
+            throw std::invalid_argument("Timeframes must be whole multiples of the base interval");
+        }
+        if (std::find(timeframes.begin(), timeframes.begin() + k, tf) != timeframes.begin() + k) {
+            throw std::invalid_argument("Duplicate timeframe " + std::to_string(tf.count()) + "s");
+        }
+    }
+
+    buckets.resize(timeframes.size());
+    out.resize(timeframes.size());
+    closed.resize(timeframes.size(), 0);
+    for (std::size_t k = 0; k < timeframes.size(); ++k) {
+        out[k].interval = timeframes[k];
+    }
+}
+
+std::chrono::system_clock::time_point Resampler::bucket_start(
+    std::chrono::system_clock::time_point ts, std::chrono::seconds interval) const {
+    auto t = std::chrono::floor<std::chrono::seconds>(ts.time_since_epoch()) - offset;
+    auto q = t.count() / interval.count();
+    if (t.count() % interval.count() < 0) --q;
+    return std::chrono::system_clock::time_point{q * interval + offset};
+}
+
+void Resampler::close(std::size_t k) {
+    out[k].bars.push_back(std::move(buckets[k].partial));
+    buckets[k].open = false;
+    ++closed[k];
+}
+
+void Resampler::close_all() {
+    for (std::size_t k = 0; k < buckets.size(); ++k) {
+        if (buckets[k].open) close(k);
+    }
+}
+
+const std::vector<std::size_t>& Resampler::update(const Bar& bar) {
+    // Checked before any state changes: a resent or late bar would
+    // otherwise be merged into its bucket a second time.
+    bool same_symbol = seen_any && bar.symbol == symbol;
+    if (same_symbol && bar.timestamp <= last_timestamp) {
+        throw std::invalid_argument("Resampler: bars must arrive in strictly increasing time order");
+    }
+
+    std::fill(closed.begin(), closed.end(), 0);
+    if (seen_any && !same_symbol) {
+        close_all();
+        for (std::size_t k = 0; k < buckets.size(); ++k) {
+            buckets[k].symbol_begin = out[k].bars.size();
+        }
+    }
+    symbol = bar.symbol;
+    last_timestamp = bar.timestamp;
+    seen_any = true;
+
+    for (std::size_t k = 0; k < buckets.size(); ++k) {
+        auto& b = buckets[k];
+        auto start = bucket_start(bar.timestamp, out[k].interval);
+
+        if (b.open && start != b.start) {
+            close(k);
+        }
+
+        if (!b.open) {
+            b.partial = bar;
+            b.partial.timestamp = start;
+            b.start = start;
+            b.open = true;
+        } else {
+            b.partial.high = std::max(b.partial.high, bar.high);
+            b.partial.low = std::min(b.partial.low, bar.low);
+            b.partial.close = bar.close;
+            b.partial.volume += bar.volume;
+        }
+
+        // This base bar ends the bucket; emit now instead of waiting for
+        // the next one.
+        if (bar.timestamp + base >= start + out[k].interval) {
+            close(k);
+        }
+
+        out[k].align.push_back(out[k].bars.size() > b.symbol_begin ? out[k].bars.size() - 1
+                                                                   : ResampledSeries::npos);
+    }
+    return closed;
+}
+
+const std::vector<std::size_t>& Resampler::flush() {
+    std::fill(closed.begin(), closed.end(), 0);
+    close_all();
+    return closed;
+}
+
+void Resampler::discard_emitted() {
+    for (std::size_t k = 0; k < out.size(); ++k) {
+        auto& bars = out[k].bars;
+        std::size_t keep = bars.size() > buckets[k].symbol_begin ? 1 : 0;
+        bars.erase(bars.begin(), bars.end() - keep);
+        buckets[k].symbol_begin = 0;
+        out[k].align.clear();
+    }
+}
+
+const Bar* Resampler::current(std::size_t k) const {
+    return buckets.at(k).open ? &buckets[k].partial : nullptr;
+}
+
+std::vector<ResampledSeries> Resampler::resample(const std::vector<Bar>& bars,
+                                                 std::chrono::seconds base,
+                                                 std::vector<std::chrono::seconds> timeframes,
+                                                 std::chrono::seconds session_offset) {
+    Resampler r(base, std::move(timeframes), session_offset);
+    for (auto& s : r.out) {
+        s.align.reserve(bars.size());
+        s.bars.reserve(bars.size() / static_cast<std::size_t>(s.interval / base) + 1);
+    }
+    for (const auto& bar : bars) {
+        r.update(bar);
+    }
+    return std::move(r.out);
+}
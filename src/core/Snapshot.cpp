@@ -0,0 +1,272 @@
+#include "core/Snapshot.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char SNAPSHOT_MAGIC[8] = {'L', 'A', 'M', 'O', 'D', 'E', 'L', '\0'};
+
+static unsigned long process_id() {
+#ifdef _WIN32
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(::getpid());
+#endif
+}
+
+static std::size_t align_up(std::size_t n) {
+    return (n + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1);
+}
+
+
+SnapshotWriter::SnapshotWriter() : buf(sizeof(SnapshotHeader), 0) {}
+
+void SnapshotWriter::pad() {
+    buf.resize(align_up(buf.size()), 0);
+}
+
+void SnapshotWriter::write_bytes(const void* p, std::size_t n) {
+    const char* bytes = static_cast<const char*>(p);
+    buf.insert(buf.end(), bytes, bytes + n);
+    pad();
+}
+
+void SnapshotWriter::write_strings(const std::vector<std::string>& strs) {
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(strs.size() + 1);
+    std::string blob;
+    for (const auto& str : strs) {
+        offsets.push_back(blob.size());
+        blob += str;
+    }
+    offsets.push_back(blob.size());
+
+    write<std::uint64_t>(strs.size());
+    write_array(offsets.data(), offsets.size());
+    write_bytes(blob.data(), blob.size());
+}
+
+void SnapshotWriter::begin_record(std::uint32_t type) {
+    RecordHeader h{type, 0, 0};
+    write(h);
+    open_records.push_back(buf.size());
+}
+
+void SnapshotWriter::end_record() {
+    if (open_records.empty()) {
+        throw std::logic_error("end_record without matching begin_record");
+    }
+    std::size_t body_start = open_records.back();
+    open_records.pop_back();
+
+    std::uint64_t body_size = buf.size() - body_start;
+    std::memcpy(buf.data() + body_start - sizeof(RecordHeader) + offsetof(RecordHeader, size),
+                &body_size, sizeof(body_size));
+}
+
+const std::vector<char>& SnapshotWriter::finish() {
+    if (!open_records.empty()) {
+        throw std::logic_error("Snapshot finished with unterminated records");
+    }
+    SnapshotHeader h{};
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.endian = SNAPSHOT_ENDIAN_TAG;
+    h.payload_size = buf.size() - sizeof(SnapshotHeader);
+    std::memcpy(buf.data(), &h, sizeof(h));
+    return buf;
+}
+
+void SnapshotWriter::save(const std::string& path) {
+    const auto& bytes = finish();
+
+    // Write beside the target and rename so readers never map a partial
+    // file. The temp name is unique per process, thread and call, so
+    // concurrent saves to one path cannot interleave inside the same file.
+    static std::atomic<std::uint64_t> save_counter{0};
+    std::string tmp = path + ".tmp." + std::to_string(process_id()) + "." +
+                      std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) +
+                      "." + std::to_string(save_counter++);
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) throw std::runtime_error("Could not open " + tmp);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        out.close();
+        if (!out) {
+            std::filesystem::remove(tmp, ec);
+            throw std::runtime_error("Failed to write " + tmp);
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::error_code ignored;
+        std::filesystem::remove(tmp, ignored);
+        throw std::runtime_error("Could not replace " + path + ": " + ec.message());
+    }
+}
+
+
+SnapshotReader::SnapshotReader(const char* data, std::size_t size)
+    : data(data), size(size), pos(0) {
+    if (reinterpret_cast<std::uintptr_t>(data) % SNAPSHOT_ALIGN != 0) {
+        throw std::runtime_error("Snapshot buffer is not 8-byte aligned");
+    }
+    if (size < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot too small");
+    }
+
+    SnapshotHeader h;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0) {
+        throw std::runtime_error("Not a model snapshot");
+    }
+    if (h.endian != SNAPSHOT_ENDIAN_TAG) {
+        throw std::runtime_error("Snapshot was written with a different byte order");
+    }
+    if (h.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(h.version));
+    }
+    if (h.payload_size != size - sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    pos = sizeof(SnapshotHeader);
+}
+
+std::size_t SnapshotReader::limit() const {
+    return (record_ends.empty() ? size : record_ends.back()) - pos;
+}
+
+const char* SnapshotReader::read_bytes(std::size_t n) {
+    std::size_t padded = align_up(n);
+    if (padded < n || padded > limit()) {
+        throw std::runtime_error("Snapshot read past end of record");
+    }
+    const char* p = data + pos;
+    pos += padded;
+    return p;
+}
+
+std::vector<std::string> SnapshotReader::read_strings() {
+    std::uint64_t n = read<std::uint64_t>();
+    if (n >= limit() / sizeof(std::uint64_t)) {
+        throw std::runtime_error("Snapshot string table exceeds record bounds");
+    }
+    const std::uint64_t* offsets = read_array<std::uint64_t>(n + 1);
+    const char* blob = read_bytes(offsets[n]);
+
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (std::uint64_t i = 0; i < n; ++i) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > offsets[n]) {
+            throw std::runtime_error("Corrupt snapshot string table");
+        }
+        out.emplace_back(blob + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    return out;
+}
+
+std::uint32_t SnapshotReader::peek_type() const {
+    if (limit() < sizeof(RecordHeader)) {
+        throw std::runtime_error("Snapshot read past end of record");
+    }
+    return reinterpret_cast<const RecordHeader*>(data + pos)->type;
+}
+
+void SnapshotReader::begin_record(std::uint32_t expected_type) {
+    const auto& h = read<RecordHeader>();
+    if (h.type != expected_type) {
+        throw std::runtime_error("Unexpected snapshot record type " + std::to_string(h.type));
+    }
+    if (h.size > limit() || h.size % SNAPSHOT_ALIGN != 0) {
+        throw std::runtime_error("Corrupt snapshot record size");
+    }
+    record_ends.push_back(pos + h.size);
+}
+
+void SnapshotReader::end_record() {
+    if (record_ends.empty()) {
+        throw std::logic_error("end_record without matching begin_record");
+    }
+    pos = record_ends.back();
+    record_ends.pop_back();
+}
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Could not open " + path);
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(file, &sz) || sz.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not map empty file " + path);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not map " + path);
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Could not map " + path);
+    }
+
+    ptr = static_cast<const char*>(view);
+    len = static_cast<std::size_t>(sz.QuadPart);
+    file_handle = file;
+    map_handle = mapping;
+}
+
+MappedFile::~MappedFile() {
+    if (ptr) UnmapViewOfFile(ptr);
+    if (map_handle) CloseHandle(map_handle);
+    if (file_handle) CloseHandle(file_handle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not map empty file " + path);
+    }
+
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) throw std::runtime_error("Could not map " + path);
+
+    ptr = static_cast<const char*>(view);
+    len = static_cast<std::size_t>(st.st_size);
+}
+
+MappedFile::~MappedFile() {
+    if (ptr) ::munmap(const_cast<char*>(ptr), len);
+}
+
+#endif
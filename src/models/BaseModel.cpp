@@ -0,0 +1,62 @@
+#include "models/BaseModel.hpp"
+#include "models/LinearModel.hpp"
+#include "models/OnlineBoost.hpp"
+#include "models/RegimeSwitch.hpp"
+#include "models/RidgeModel.hpp"
+#include <optional>
+
+void BaseModel::fit_stream(BarStream& stream) {
+    FeatureStream features;
+    std::vector<Bar> chunk;
+    std::vector<FeatureRow> rows;
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    std::optional<FeatureRow> pending;
+
+    while (stream.next(chunk)) {
+        features.update(chunk, rows);
+        X.clear();
+        y.clear();
+
+        // The last row of the previous chunk is labelled by this chunk's first bar.
+        if (pending && pending->symbol == chunk.front().symbol) {
+            X.push_back(std::move(*pending));
+            y.push_back(chunk.front().close);
+        }
+        pending = std::move(rows.back());
+
+        for (std::size_t i = 0; i + 1 < chunk.size(); ++i) {
+            if (rows[i].symbol == chunk[i + 1].symbol) {
+                X.push_back(std::move(rows[i]));
+                y.push_back(chunk[i + 1].close);
+            }
+        }
+
+        if (!X.empty()) {
+            partial_fit(X, y);
+        }
+    }
+    end_pass();
+}
+
+void BaseModel::save(const std::string& path) const {
+    SnapshotWriter w;
+    save(w);
+    w.save(path);
+}
+
+std::unique_ptr<BaseModel> BaseModel::load(SnapshotReader& r) {
+    switch (static_cast<ModelType>(r.peek_type())) {
+        case ModelType::Linear:       return LinearModel::load(r);
+        case ModelType::OnlineBoost:  return OnlineBoost::load(r);
+        case ModelType::RegimeSwitch: return RegimeSwitch::load(r);
+        case ModelType::Ridge:        return RidgeModel::load(r);
+    }
+    throw std::runtime_error("Unknown model type in snapshot: " + std::to_string(r.peek_type()));
+}
+
+std::unique_ptr<BaseModel> BaseModel::load(const std::string& path) {
+    MappedFile file(path);
+    SnapshotReader r(file.data(), file.size());
+    return load(r);
+}
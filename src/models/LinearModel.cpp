@@ -1,16 +1,9 @@
 #include "models/LinearModel.hpp"
+#include "core/Instrumentation.hpp"
 #include <cmath>
 #include <stdexcept>
 
-void LinearModel::fit(const std::vector<FeatureRow>& X,
-                      const std::vector<double>& y) {
-    if (X.size() != y.size()) {
-        throw std::invalid_argument("X and y must have same size");
-    }
-
-
-    feature_names.clear();
-    feature_index.clear();
+void LinearModel::index_features(const std::vector<FeatureRow>& X) {
     for (const auto& row : X) {
         for (const auto& kv : row.values) {
             if (!feature_index.count(kv.first)) {
@@ -19,46 +12,79 @@ void LinearModel::fit(const std::vector<FeatureRow>& X,
             }
         }
     }
+    weights.resize(feature_names.size() + 1, 0.0);
+}
 
-    std::size_t p = feature_names.size();
-    weights.assign(p + 1, 0.0);
-
-
-    for (int epoch = 0; epoch < epochs; ++epoch) {
-        double lr = learning_rate / (1.0 + decay * epoch);
-
-        for (std::size_t i = 0; i < X.size(); ++i) {
+void LinearModel::sgd_pass(const std::vector<FeatureRow>& X,
+                           const std::vector<double>& y, double lr) {
+    for (std::size_t i = 0; i < X.size(); ++i) {
 
-            double linear = weights[0];
-            for (const auto& kv : X[i].values) {
-                auto it = feature_index.find(kv.first);
-                if (it != feature_index.end() && !std::isnan(kv.second)) {
-                    linear += weights[it->second + 1] * kv.second;
-                }
+        double linear = weights[0];
+        for (const auto& kv : X[i].values) {
+            auto it = feature_index.find(kv.first);
+            if (it != feature_index.end() && !std::isnan(kv.second)) {
+                linear += weights[it->second + 1] * kv.second;
             }
+        }
 
 
-            double pred = logistic ? 1.0 / (1.0 + std::exp(-linear)) : linear;
+        double pred = logistic ? 1.0 / (1.0 + std::exp(-linear)) : linear;
 
 
-            double error = pred - y[i];
+        double error = pred - y[i];
 
 
-            weights[0] -= lr * error;
+        weights[0] -= lr * error;
 
 
-            for (const auto& kv : X[i].values) {
-                auto it = feature_index.find(kv.first);
-                if (it != feature_index.end() && !std::isnan(kv.second)) {
-                    std::size_t idx = it->second + 1;
-                    weights[idx] -= lr * (error * kv.second + lambda * weights[idx]);
-                }
+        for (const auto& kv : X[i].values) {
+            auto it = feature_index.find(kv.first);
+            if (it != feature_index.end() && !std::isnan(kv.second)) {
+                std::size_t idx = it->second + 1;
+                weights[idx] -= lr * (error * kv.second + lambda * weights[idx]);
             }
         }
     }
 }
 
+void LinearModel::fit(const std::vector<FeatureRow>& X,
+                      const std::vector<double>& y) {
+    LA_SCOPED_STAGE(Stage::Fit);
+    if (X.size() != y.size()) {
+        throw std::invalid_argument("X and y must have same size");
+    }
+    LA_COUNT_ITEMS(Stage::Fit, X.size() * static_cast<std::size_t>(epochs));
+
+
+    feature_names.clear();
+    feature_index.clear();
+    weights.clear();
+    index_features(X);
+
+
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        double lr = learning_rate / (1.0 + decay * epoch);
+        sgd_pass(X, y, lr);
+    }
+    passes = epochs > 0 ? static_cast<std::uint64_t>(epochs) : 0;
+}
+
+void LinearModel::partial_fit(const std::vector<FeatureRow>& X,
+                              const std::vector<double>& y) {
+    LA_SCOPED_STAGE(Stage::Fit);
+    if (X.size() != y.size()) {
+        throw std::invalid_argument("X and y must have same size");
+    }
+    LA_COUNT_ITEMS(Stage::Fit, X.size());
+
+    index_features(X);
+
+    double lr = learning_rate / (1.0 + decay * static_cast<double>(passes));
+    sgd_pass(X, y, lr);
+}
+
 double LinearModel::predict(const FeatureRow& x) const {
+    LA_SCOPED_STAGE(Stage::Predict);
     double linear = weights.empty() ? 0.0 : weights[0];
     for (const auto& kv : x.values) {
         auto it = feature_index.find(kv.first);
@@ -69,3 +95,41 @@ double LinearModel::predict(const FeatureRow& x) const {
 
     return logistic ? 1.0 / (1.0 + std::exp(-linear)) : linear;
 }
+
+void LinearModel::save(SnapshotWriter& w) const {
+    w.begin_record(static_cast<std::uint32_t>(ModelType::Linear));
+
+    SnapshotParams params{learning_rate, lambda, decay, epochs, logistic ? 1u : 0u,
+                        weights.size(), passes};
+    w.write(params);
+    w.write_array(weights.data(), weights.size());
+    w.write_strings(feature_names);
+
+    w.end_record();
+}
+
+std::unique_ptr<LinearModel> LinearModel::load(SnapshotReader& r) {
+    r.begin_record(static_cast<std::uint32_t>(ModelType::Linear));
+
+    const auto& params = r.read<SnapshotParams>();
+    auto model = std::make_unique<LinearModel>(params.learning_rate, params.epochs,
+                                               params.lambda, params.decay,
+                                               params.logistic != 0);
+    model->passes = params.passes;
+
+    const double* w = r.read_array<double>(params.n_weights);
+    model->weights.assign(w, w + params.n_weights);
+
+    model->feature_names = r.read_strings();
+    bool untrained = model->weights.empty() && model->feature_names.empty();
+    if (!untrained && model->weights.size() != model->feature_names.size() + 1) {
+        throw std::runtime_error("Corrupt LinearModel snapshot: weight count mismatch");
+    }
+    model->feature_index.reserve(model->feature_names.size());
+    for (std::size_t i = 0; i < model->feature_names.size(); ++i) {
+        model->feature_index[model->feature_names[i]] = i;
+    }
+
+    r.end_record();
+    return model;
+}
@@ -20,6 +20,24 @@ void OnlineBoost::fit(const std::vector<FeatureRow>& X,
     }
 }
 
+void OnlineBoost::partial_fit(const std::vector<FeatureRow>& X,
+                              const std::vector<double>& y) {
+    std::vector<double> residual = y;
+    for (auto& lm : learners) {
+        lm.partial_fit(X, residual);
+        auto preds = lm.predict(X);
+        for (std::size_t i = 0; i < residual.size(); ++i) {
+            residual[i] -= shrinkage * preds[i];
+        }
+    }
+}
+
+void OnlineBoost::end_pass() {
+    for (auto& lm : learners) {
+        lm.end_pass();
+    }
+}
+
 double OnlineBoost::predict(const FeatureRow& x) const {
     double out = 0.0;
     for (const auto& lm : learners) {
@@ -27,3 +45,34 @@ double OnlineBoost::predict(const FeatureRow& x) const {
     }
     return out;
 }
+
+namespace {
+
+struct OnlineBoostParams {
+    double shrinkage;
+    std::uint64_t n_learners;
+};
+
+}
+
+void OnlineBoost::save(SnapshotWriter& w) const {
+    w.begin_record(static_cast<std::uint32_t>(ModelType::OnlineBoost));
+    w.write(OnlineBoostParams{shrinkage, learners.size()});
+    for (const auto& lm : learners) {
+        lm.save(w);
+    }
+    w.end_record();
+}
+
+std::unique_ptr<OnlineBoost> OnlineBoost::load(SnapshotReader& r) {
+    r.begin_record(static_cast<std::uint32_t>(ModelType::OnlineBoost));
+
+    const auto& params = r.read<OnlineBoostParams>();
+    auto model = std::make_unique<OnlineBoost>(0, 0.01, params.shrinkage);
+    for (std::uint64_t i = 0; i < params.n_learners; ++i) {
+        model->learners.push_back(std::move(*LinearModel::load(r)));
+    }
+
+    r.end_record();
+    return model;
+}
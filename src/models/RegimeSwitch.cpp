@@ -8,11 +8,9 @@ RegimeSwitch::RegimeSwitch(std::unique_ptr<BaseModel> bull,
       bear_model(std::move(bear)),
       threshold(thresh) {}
 
-void RegimeSwitch::fit(const std::vector<FeatureRow>& X,
-                       const std::vector<double>& y) {
-    std::vector<FeatureRow> bull_X, bear_X;
-    std::vector<double> bull_y, bear_y;
-
+void RegimeSwitch::split(const std::vector<FeatureRow>& X, const std::vector<double>& y,
+                         std::vector<FeatureRow>& bull_X, std::vector<double>& bull_y,
+                         std::vector<FeatureRow>& bear_X, std::vector<double>& bear_y) const {
     for (std::size_t i = 0; i < X.size(); ++i) {
         auto it = X[i].values.find("rsi14");
         double val = (it != X[i].values.end() && !std::isnan(it->second))
@@ -26,6 +24,13 @@ void RegimeSwitch::fit(const std::vector<FeatureRow>& X,
             bear_y.push_back(y[i]);
         }
     }
+}
+
+void RegimeSwitch::fit(const std::vector<FeatureRow>& X,
+                       const std::vector<double>& y) {
+    std::vector<FeatureRow> bull_X, bear_X;
+    std::vector<double> bull_y, bear_y;
+    split(X, y, bull_X, bull_y, bear_X, bear_y);
 
     if (bull_model && !bull_X.empty()) {
         bull_model->fit(bull_X, bull_y);
@@ -35,6 +40,25 @@ void RegimeSwitch::fit(const std::vector<FeatureRow>& X,
     }
 }
 
+void RegimeSwitch::partial_fit(const std::vector<FeatureRow>& X,
+                               const std::vector<double>& y) {
+    std::vector<FeatureRow> bull_X, bear_X;
+    std::vector<double> bull_y, bear_y;
+    split(X, y, bull_X, bull_y, bear_X, bear_y);
+
+    if (bull_model && !bull_X.empty()) {
+        bull_model->partial_fit(bull_X, bull_y);
+    }
+    if (bear_model && !bear_X.empty()) {
+        bear_model->partial_fit(bear_X, bear_y);
+    }
+}
+
+void RegimeSwitch::end_pass() {
+    if (bull_model) bull_model->end_pass();
+    if (bear_model) bear_model->end_pass();
+}
+
 double RegimeSwitch::predict(const FeatureRow& x) const {
     auto it = x.values.find("rsi14");
     double val = (it != x.values.end() && !std::isnan(it->second)) ? it->second : 50.0;
@@ -43,3 +67,32 @@ double RegimeSwitch::predict(const FeatureRow& x) const {
     }
     return bear_model ? bear_model->predict(x) : 0.0;
 }
+
+namespace {
+
+struct RegimeSwitchParams {
+    double threshold;
+    std::uint32_t has_bull;
+    std::uint32_t has_bear;
+};
+
+}
+
+void RegimeSwitch::save(SnapshotWriter& w) const {
+    w.begin_record(static_cast<std::uint32_t>(ModelType::RegimeSwitch));
+    w.write(RegimeSwitchParams{threshold, bull_model ? 1u : 0u, bear_model ? 1u : 0u});
+    if (bull_model) bull_model->save(w);
+    if (bear_model) bear_model->save(w);
+    w.end_record();
+}
+
+std::unique_ptr<RegimeSwitch> RegimeSwitch::load(SnapshotReader& r) {
+    r.begin_record(static_cast<std::uint32_t>(ModelType::RegimeSwitch));
+
+    const auto& params = r.read<RegimeSwitchParams>();
+    std::unique_ptr<BaseModel> bull = params.has_bull ? BaseModel::load(r) : nullptr;
+    std::unique_ptr<BaseModel> bear = params.has_bear ? BaseModel::load(r) : nullptr;
+
+    r.end_record();
+    return std::make_unique<RegimeSwitch>(std::move(bull), std::move(bear), params.threshold);
+}
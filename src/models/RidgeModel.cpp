@@ -0,0 +1,261 @@
+#include "models/RidgeModel.hpp"
+#include "core/Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+void RidgeModel::fit(const std::vector<FeatureRow>& X,
+                     const std::vector<double>& y) {
+    if (X.size() != y.size()) {
+        throw std::invalid_argument("X and y must have same size");
+    }
+    n_samples = 0;
+    feature_names.clear();
+    feature_index.clear();
+    mean_x.clear();
+    mean_y = 0.0;
+    comoment.clear();
+    cross_y.clear();
+    weights.clear();
+    partial_fit(X, y);
+}
+
+void RidgeModel::partial_fit(const std::vector<FeatureRow>& X,
+                             const std::vector<double>& y) {
+    LA_SCOPED_STAGE(Stage::Fit);
+    if (X.size() != y.size()) {
+        throw std::invalid_argument("X and y must have same size");
+    }
+    LA_COUNT_ITEMS(Stage::Fit, X.size());
+
+    // Register new features and size every buffer up front, so nothing
+    // below can fail once the accumulators start changing. Features first
+    // seen now were implicitly zero in earlier rows, so their means and
+    // co-moments start at zero.
+    auto names = feature_names;
+    auto index = feature_index;
+    for (const auto& row : X) {
+        for (const auto& kv : row.values) {
+            if (!index.count(kv.first)) {
+                index[kv.first] = names.size();
+                names.push_back(kv.first);
+            }
+        }
+    }
+    std::size_t old_p = feature_names.size();
+    std::size_t p = names.size();
+
+    std::vector<double> means = mean_x;
+    std::vector<double> cov = comoment;
+    std::vector<double> cxy = cross_y;
+    if (p != old_p) {
+        means.resize(p, 0.0);
+        cxy.resize(p, 0.0);
+        cov.assign(p * p, 0.0);
+        for (std::size_t a = 0; a < old_p; ++a) {
+            for (std::size_t b = a; b < old_p; ++b) {
+                cov[a * p + b] = comoment[a * old_p + b];
+            }
+        }
+    }
+    std::vector<double> x(p), dx(p);
+
+    std::uint64_t n = n_samples;
+    double my = mean_y;
+    for (std::size_t i = 0; i < X.size(); ++i) {
+        std::fill(x.begin(), x.end(), 0.0);
+        for (const auto& kv : X[i].values) {
+            if (!std::isnan(kv.second)) {
+                x[index.find(kv.first)->second] = kv.second;
+            }
+        }
+
+        ++n;
+        double inv = 1.0 / static_cast<double>(n);
+        for (std::size_t a = 0; a < p; ++a) {
+            dx[a] = x[a] - means[a];
+            means[a] += dx[a] * inv;
+        }
+        my += (y[i] - my) * inv;
+        double ry = y[i] - my;
+
+        for (std::size_t a = 0; a < p; ++a) {
+            for (std::size_t b = a; b < p; ++b) {
+                cov[a * p + b] += dx[a] * (x[b] - means[b]);
+            }
+            cxy[a] += dx[a] * ry;
+        }
+    }
+
+    feature_names.swap(names);
+    feature_index.swap(index);
+    mean_x.swap(means);
+    comoment.swap(cov);
+    cross_y.swap(cxy);
+    mean_y = my;
+    n_samples = n;
+    dirty.store(true, std::memory_order_release);
+}
+
+void RidgeModel::ensure_solved() const {
+    if (!dirty.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(solve_mutex);
+    if (!dirty.load(std::memory_order_relaxed)) return;
+    solve();
+    dirty.store(false, std::memory_order_release);
+}
+
+// Solves (R + lambda / n * I) beta = r on unit-norm centred columns, where
+// R is their Gram matrix, then maps beta back to raw feature weights.
+// Constant columns get zero weight. If rounding still leaves the system
+// indefinite the ridge is raised until Cholesky succeeds, so solving never
+// throws.
+void RidgeModel::solve() const {
+    std::size_t p = feature_names.size();
+    std::vector<double> w(p + 1, 0.0);
+    if (n_samples == 0) {
+        weights.swap(w);
+        return;
+    }
+
+    std::vector<std::size_t> active;
+    std::vector<double> scale;
+    for (std::size_t a = 0; a < p; ++a) {
+        double c = comoment[a * p + a];
+        if (c > 0.0 && std::isfinite(c)) {
+            active.push_back(a);
+            scale.push_back(std::sqrt(c));
+        }
+    }
+
+    std::size_t m = active.size();
+    std::vector<double> beta(m, 0.0);
+    if (m > 0) {
+        std::vector<double> R(m * m), r(m), L(m * m);
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t j = i; j < m; ++j) {
+                R[i * m + j] = comoment[active[i] * p + active[j]] / (scale[i] * scale[j]);
+            }
+            r[i] = cross_y[active[i]] / scale[i];
+        }
+
+        double ridge = lambda / static_cast<double>(n_samples);
+        bool ok = false;
+        for (int attempt = 0; attempt < 16 && !ok; ++attempt) {
+            ok = true;
+            for (std::size_t j = 0; j < m && ok; ++j) {
+                double d = R[j * m + j] + ridge;
+                for (std::size_t k = 0; k < j; ++k) d -= L[j * m + k] * L[j * m + k];
+                if (!(d > 0.0)) {
+                    ok = false;
+                    break;
+                }
+                L[j * m + j] = std::sqrt(d);
+                for (std::size_t i = j + 1; i < m; ++i) {
+                    double s = R[j * m + i];
+                    for (std::size_t k = 0; k < j; ++k) s -= L[i * m + k] * L[j * m + k];
+                    L[i * m + j] = s / L[j * m + j];
+                }
+            }
+            if (!ok) ridge = std::max(ridge * 10.0, 1e-12);
+        }
+
+        if (ok) {
+            std::vector<double> z(m);
+            for (std::size_t i = 0; i < m; ++i) {
+                double s = r[i];
+                for (std::size_t k = 0; k < i; ++k) s -= L[i * m + k] * z[k];
+                z[i] = s / L[i * m + i];
+            }
+            for (std::size_t i = m; i-- > 0;) {
+                double s = z[i];
+                for (std::size_t k = i + 1; k < m; ++k) s -= L[k * m + i] * beta[k];
+                beta[i] = s / L[i * m + i];
+            }
+        }
+    }
+
+    double intercept = mean_y;
+    for (std::size_t i = 0; i < m; ++i) {
+        double wa = beta[i] / scale[i];
+        w[active[i] + 1] = wa;
+        intercept -= wa * mean_x[active[i]];
+    }
+    w[0] = intercept;
+    weights.swap(w);
+}
+
+double RidgeModel::predict(const FeatureRow& x) const {
+    LA_SCOPED_STAGE(Stage::Predict);
+    ensure_solved();
+    double linear = weights.empty() ? 0.0 : weights[0];
+    for (const auto& kv : x.values) {
+        auto it = feature_index.find(kv.first);
+        if (it != feature_index.end() && !std::isnan(kv.second)) {
+            linear += weights[it->second + 1] * kv.second;
+        }
+    }
+    return linear;
+}
+
+namespace {
+
+struct RidgeParams {
+    double lambda;
+    double mean_y;
+    std::uint64_t n_samples;
+    std::uint64_t n_features;
+};
+
+}
+
+void RidgeModel::save(SnapshotWriter& w) const {
+    ensure_solved();
+    std::size_t p = feature_names.size();
+    std::vector<double> solved = weights;
+    solved.resize(p + 1, 0.0);
+
+    w.begin_record(static_cast<std::uint32_t>(ModelType::Ridge));
+    w.write(RidgeParams{lambda, mean_y, n_samples, p});
+    w.write_array(solved.data(), solved.size());
+    w.write_array(mean_x.data(), mean_x.size());
+    w.write_array(cross_y.data(), cross_y.size());
+    w.write_array(comoment.data(), comoment.size());
+    w.write_strings(feature_names);
+    w.end_record();
+}
+
+std::unique_ptr<RidgeModel> RidgeModel::load(SnapshotReader& r) {
+    r.begin_record(static_cast<std::uint32_t>(ModelType::Ridge));
+
+    const auto& params = r.read<RidgeParams>();
+    std::uint64_t p = params.n_features;
+    if (p >= SIZE_MAX / sizeof(double) || (p != 0 && p > SIZE_MAX / sizeof(double) / p)) {
+        throw std::runtime_error("Corrupt RidgeModel snapshot: dimension overflow");
+    }
+    auto model = std::make_unique<RidgeModel>(params.lambda);
+    model->n_samples = params.n_samples;
+    model->mean_y = params.mean_y;
+
+    const double* w = r.read_array<double>(p + 1);
+    model->weights.assign(w, w + p + 1);
+    const double* mx = r.read_array<double>(p);
+    model->mean_x.assign(mx, mx + p);
+    const double* cy = r.read_array<double>(p);
+    model->cross_y.assign(cy, cy + p);
+    const double* c = r.read_array<double>(p * p);
+    model->comoment.assign(c, c + p * p);
+
+    model->feature_names = r.read_strings();
+    if (model->feature_names.size() != p) {
+        throw std::runtime_error("Corrupt RidgeModel snapshot: feature count mismatch");
+    }
+    model->feature_index.reserve(model->feature_names.size());
+    for (std::size_t i = 0; i < model->feature_names.size(); ++i) {
+        model->feature_index[model->feature_names[i]] = i;
+    }
+
+    r.end_record();
+    return model;
+}
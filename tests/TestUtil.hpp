@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core/DataLoader.hpp"
+#include "core/FeatureEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Minimal assertion helpers: each test binary returns the failure count.
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                           \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond      \
+                      << ") failed\n";                                        \
+            ++test_failures();                                                \
+        }                                                                     \
+    } while (0)
+
+#define CHECK_THROWS(expr)                                                    \
+    do {                                                                      \
+        bool threw = false;                                                   \
+        try { (void)(expr); } catch (const std::exception&) { threw = true; } \
+        if (!threw) {                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #expr            \
+                      << " did not throw\n";                                  \
+            ++test_failures();                                                \
+        }                                                                     \
+    } while (0)
+
+#define CHECK_THROWS_WITH(expr, text)                                         \
+    do {                                                                      \
+        std::string what;                                                     \
+        try { (void)(expr); } catch (const std::exception& e) { what = e.what(); } \
+        if (what.find(text) == std::string::npos) {                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #expr            \
+                      << " did not throw \"" << (text) << "\" (got \""      \
+                      << what << "\")\n";                                     \
+            ++test_failures();                                                \
+        }                                                                     \
+    } while (0)
+
+// Equal, or both NaN.
+inline bool same_value(double a, double b) {
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+// Random-walk OHLCV bars, one every `step` starting at `start`.
+inline std::vector<Bar> make_bars(std::size_t n, const std::string& symbol,
+                                  double price, std::uint32_t seed,
+                                  std::chrono::seconds step = std::chrono::seconds{60},
+                                  std::chrono::system_clock::time_point start = {}) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> move(0.0, 0.002);
+    std::uniform_real_distribution<double> wick(0.0, 0.001);
+    std::uniform_real_distribution<double> vol(1.0, 100.0);
+
+    std::vector<Bar> bars;
+    bars.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double open = price;
+        price *= 1.0 + move(rng);
+        Bar b;
+        b.timestamp = start + step * static_cast<long long>(i);
+        b.open = open;
+        b.close = price;
+        b.high = std::max(open, price) * (1.0 + wick(rng));
+        b.low = std::min(open, price) * (1.0 - wick(rng));
+        b.volume = vol(rng);
+        b.symbol = symbol;
+        bars.push_back(b);
+    }
+    return bars;
+}
+
+// Pairs each bar's feature row with the next close, skipping the first
+// `warmup` rows while indicators are still NaN.
+inline void training_set(const std::vector<Bar>& bars,
+                         std::vector<FeatureRow>& X, std::vector<double>& y,
+                         std::size_t warmup = 0) {
+    auto rows = FeatureEngine::make_features(bars);
+    for (std::size_t i = warmup; i + 1 < rows.size(); ++i) {
+        X.push_back(rows[i]);
+        y.push_back(bars[i + 1].close);
+    }
+}
+
+// Serves an in-memory history in fixed-size chunks.
+class VectorBarStream : public BarStream {
+public:
+    VectorBarStream(const std::vector<Bar>& bars, std::size_t chunk)
+        : bars(bars), chunk(chunk) {}
+
+    bool next(std::vector<Bar>& out) override {
+        out.clear();
+        if (pos >= bars.size()) return false;
+        std::size_t end = std::min(pos + chunk, bars.size());
+        out.assign(bars.begin() + pos, bars.begin() + end);
+        pos = end;
+        return true;
+    }
+
+    std::size_t chunk_size() const override { return chunk; }
+
+private:
+    const std::vector<Bar>& bars;
+    std::size_t chunk;
+    std::size_t pos = 0;
+};
@@ -0,0 +1,94 @@
+#include "TestUtil.hpp"
+#include "core/FeatureEngine.hpp"
+
+static bool same_rows(const std::vector<FeatureRow>& a, const std::vector<FeatureRow>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].timestamp != b[i].timestamp || a[i].symbol != b[i].symbol) return false;
+        if (a[i].values.size() != b[i].values.size()) return false;
+        for (const auto& [name, v] : a[i].values) {
+            auto it = b[i].values.find(name);
+            if (it == b[i].values.end() || !same_value(v, it->second)) return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<FeatureRow> streamed(const std::vector<Bar>& bars, std::size_t chunk) {
+    FeatureStream stream;
+    std::vector<FeatureRow> all, rows;
+    for (std::size_t i = 0; i < bars.size(); i += chunk) {
+        std::vector<Bar> part(bars.begin() + i, bars.begin() + std::min(i + chunk, bars.size()));
+        stream.update(part, rows);
+        all.insert(all.end(), rows.begin(), rows.end());
+    }
+    return all;
+}
+
+static bool column_matches(const std::vector<FeatureRow>& rows, const std::string& name,
+                           const std::vector<double>& expected) {
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (!same_value(rows[i].values.at(name), expected[i])) return false;
+    }
+    return true;
+}
+
+// Any chunking must reproduce the single-pass rows exactly.
+static void test_chunking_is_invisible() {
+    auto bars = make_bars(500, "AAA", 100.0, 1);
+    auto whole = FeatureEngine::make_features(bars);
+    CHECK(whole.size() == bars.size());
+    CHECK(whole.front().values.size() == 24);
+    for (std::size_t chunk : {1, 7, 64, 500, 1000}) {
+        CHECK(same_rows(streamed(bars, chunk), whole));
+    }
+}
+
+// Rows agree with the whole-series indicator functions.
+static void test_matches_series_functions() {
+    auto bars = make_bars(300, "AAA", 60000.0, 2);
+    auto rows = FeatureEngine::make_features(bars);
+    std::vector<double> closes;
+    for (const auto& b : bars) closes.push_back(b.close);
+
+    CHECK(column_matches(rows, "ret_5", FeatureEngine::returns(closes, 5)));
+    CHECK(column_matches(rows, "rsi14", FeatureEngine::rsi(closes, 14)));
+    CHECK(column_matches(rows, "rv_48", FeatureEngine::realized_vol(closes, 48)));
+    CHECK(column_matches(rows, "range_frac", FeatureEngine::range_frac(bars)));
+    CHECK(column_matches(rows, "sma20", FeatureEngine::sma(closes, 20)));
+    CHECK(column_matches(rows, "sma50", FeatureEngine::sma(closes, 50)));
+    CHECK(column_matches(rows, "ema26", FeatureEngine::ema(closes, 26)));
+    CHECK(column_matches(rows, "atr14", FeatureEngine::atr(bars, 14)));
+
+    std::vector<double> mid, upper, lower, pctb, bw;
+    FeatureEngine::bollinger(closes, 20, 2.0, mid, upper, lower, pctb, bw);
+    CHECK(column_matches(rows, "bb20_upper", upper));
+    CHECK(column_matches(rows, "bb20_pctb", pctb));
+
+    // Independent check that the window math itself is right.
+    double sum = 0;
+    for (std::size_t i = 250; i < 270; ++i) sum += closes[i];
+    CHECK(std::fabs(rows[269].values.at("sma20") - sum / 20) < 1e-9 * sum);
+}
+
+// A new symbol starts from a cold state, whatever came before it.
+static void test_symbol_change_restarts() {
+    auto a = make_bars(120, "AAA", 100.0, 3);
+    auto b = make_bars(80, "BBB", 50.0, 4);
+    std::vector<Bar> both = a;
+    both.insert(both.end(), b.begin(), b.end());
+
+    auto rows = FeatureEngine::make_features(both);
+    auto alone = FeatureEngine::make_features(b);
+    std::vector<FeatureRow> tail(rows.begin() + a.size(), rows.end());
+    CHECK(same_rows(tail, alone));
+    CHECK(std::isnan(tail.front().values.at("ret_1")));
+    CHECK(same_rows(streamed(both, 33), rows));
+}
+
+int main() {
+    test_chunking_is_invisible();
+    test_matches_series_functions();
+    test_symbol_change_restarts();
+    return test_failures();
+}
@@ -0,0 +1,130 @@
+#include "TestUtil.hpp"
+#include "core/Instrumentation.hpp"
+#include <limits>
+#include <memory>
+
+// Every value lands in the bucket whose bounds contain it, and buckets are
+// at most 1/16 of their lower bound wide.
+static void test_bucket_bounds() {
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t v = 0; v < 5000; ++v) values.push_back(v);
+    for (unsigned shift = 4; shift < 64; ++shift) {
+        std::uint64_t p = std::uint64_t{1} << shift;
+        values.push_back(p - 1);
+        values.push_back(p);
+        values.push_back(p + 1);
+        values.push_back(p + p / 3);
+    }
+    values.push_back(std::numeric_limits<std::uint64_t>::max());
+
+    for (auto v : values) {
+        std::size_t idx = LatencyHistogram::bucket_index(v);
+        CHECK(idx < LatencyHistogram::bucket_count);
+        CHECK(LatencyHistogram::bucket_lower(idx) <= v);
+        if (idx + 1 < LatencyHistogram::bucket_count) {
+            std::uint64_t next = LatencyHistogram::bucket_lower(idx + 1);
+            CHECK(v < next);
+            CHECK(next - LatencyHistogram::bucket_lower(idx) <=
+                  std::max<std::uint64_t>(1, LatencyHistogram::bucket_lower(idx) / 16));
+        }
+    }
+
+    // Exact below 16; a few hand-computed buckets above.
+    CHECK(LatencyHistogram::bucket_index(15) == 15);
+    CHECK(LatencyHistogram::bucket_index(16) == 16);
+    CHECK(LatencyHistogram::bucket_index(32) == 32);
+    CHECK(LatencyHistogram::bucket_index(33) == 32);
+    CHECK(LatencyHistogram::bucket_lower(LatencyHistogram::bucket_index(1000)) == 992);
+    CHECK(LatencyHistogram::bucket_index(std::numeric_limits<std::uint64_t>::max()) ==
+          LatencyHistogram::bucket_count - 1);
+
+    for (std::size_t i = 0; i < LatencyHistogram::bucket_count; ++i) {
+        CHECK(LatencyHistogram::bucket_index(LatencyHistogram::bucket_lower(i)) == i);
+    }
+}
+
+static void test_percentiles() {
+    auto h = std::make_unique<LatencyHistogram>();
+    CHECK(h->percentile(0.5) == 0);
+
+    for (std::uint64_t v = 1; v <= 1000; ++v) h->record(v);
+
+    // Reported as the top of the bucket holding the rank.
+    CHECK(h->percentile(0.5) == 511);
+    CHECK(h->percentile(0.9) == 927);
+    CHECK(h->percentile(0.0) == 1);
+    CHECK(h->percentile(1.0) == 1023);
+    for (double q : {0.25, 0.5, 0.75, 0.9, 0.99}) {
+        double exact = q * 1000;
+        double got = static_cast<double>(h->percentile(q));
+        CHECK(got >= exact && got <= exact * 1.07);
+    }
+
+    h->reset();
+    CHECK(h->percentile(0.99) == 0);
+}
+
+static void test_stage_stats() {
+    Instrumentation::reset();
+    if constexpr (Instrumentation::enabled) {
+        // A single sample reports max, not its bucket's upper bound.
+        Instrumentation::record_time(Stage::Fit, 1000);
+        Instrumentation::add_items(Stage::Fit, 7);
+        auto snap = Instrumentation::snapshot();
+        CHECK(snap.size() == static_cast<std::size_t>(Stage::Count));
+        const auto& fit = snap[static_cast<std::size_t>(Stage::Fit)];
+        CHECK(fit.name == "fit");
+        CHECK(fit.calls == 1 && fit.items == 7);
+        CHECK(fit.total_ns == 1000 && fit.max_ns == 1000);
+        CHECK(fit.p50_ns == 1000 && fit.p99_ns == 1000 && fit.p999_ns == 1000);
+
+        {
+            LA_SCOPED_STAGE(Stage::Predict);
+            LA_COUNT_ITEMS(Stage::Predict, 3);
+        }
+        snap = Instrumentation::snapshot();
+        CHECK(snap[static_cast<std::size_t>(Stage::Predict)].calls == 1);
+        CHECK(snap[static_cast<std::size_t>(Stage::Predict)].items == 3);
+
+        Instrumentation::reset();
+        snap = Instrumentation::snapshot();
+        CHECK(snap[static_cast<std::size_t>(Stage::Fit)].calls == 0);
+        CHECK(snap[static_cast<std::size_t>(Stage::Fit)].max_ns == 0);
+        CHECK(snap[static_cast<std::size_t>(Stage::Fit)].p50_ns == 0);
+    } else {
+        // Macros compile to nothing and there is nothing to report.
+        {
+            LA_SCOPED_STAGE(Stage::Predict);
+            LA_COUNT_ITEMS(Stage::Predict, 3);
+        }
+        CHECK(Instrumentation::snapshot().empty());
+        CHECK(Instrumentation::stats(Stage::Predict).calls == 0);
+    }
+}
+
+static void* volatile sink;
+
+static void test_allocation_attribution() {
+    if constexpr (Instrumentation::tracks_allocations) {
+        Instrumentation::reset();
+        {
+            ScopedStageTimer timer(Stage::Features);
+            auto p = std::make_unique<char[]>(256);
+            sink = p.get();
+        }
+        sink = new char[64];
+        delete[] static_cast<char*>(sink);
+
+        const auto& st = Instrumentation::stats(Stage::Features);
+        CHECK(st.allocs == 1);
+        CHECK(st.alloc_bytes == 256);
+    }
+}
+
+int main() {
+    test_bucket_bounds();
+    test_percentiles();
+    test_stage_stats();
+    test_allocation_attribution();
+    return test_failures();
+}
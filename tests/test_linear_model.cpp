@@ -0,0 +1,58 @@
+#include "TestUtil.hpp"
+#include "models/LinearModel.hpp"
+
+static std::unique_ptr<LinearModel> train_streamed(const std::vector<Bar>& bars,
+                                                   std::size_t chunk, int passes) {
+    auto model = std::make_unique<LinearModel>(1e-7, 1, 0.0, 0.5);
+    for (int pass = 0; pass < passes; ++pass) {
+        VectorBarStream stream(bars, chunk);
+        model->fit_stream(stream);
+    }
+    return model;
+}
+
+// The chunk size bounds memory only; with learning-rate decay the trained
+// model must still be the same for every chunking.
+static void test_chunking_does_not_change_model() {
+    auto bars = make_bars(3000, "AAA", 100.0, 31);
+    auto rows = FeatureEngine::make_features(bars);
+
+    auto whole = train_streamed(bars, bars.size(), 3);
+    for (std::size_t chunk : {256, 4096, 1000}) {
+        auto chunked = train_streamed(bars, chunk, 3);
+        for (std::size_t i = 100; i < rows.size(); i += 97) {
+            double a = whole->predict(rows[i]);
+            CHECK(std::isfinite(a));
+            CHECK(a == chunked->predict(rows[i]));
+        }
+    }
+}
+
+// The completed-pass count that drives decay survives a snapshot, so a
+// restored model continues training exactly as the original would.
+static void test_decay_counts_passes() {
+    auto bars = make_bars(1000, "AAA", 100.0, 32);
+    auto rows = FeatureEngine::make_features(bars);
+    const FeatureRow& probe = rows.back();
+
+    auto one = train_streamed(bars, 128, 1);
+    auto two = train_streamed(bars, 128, 2);
+
+    SnapshotWriter w;
+    two->save(w);
+    const auto& bytes = w.finish();
+    SnapshotReader r(bytes.data(), bytes.size());
+    auto restored = BaseModel::load(r);
+
+    VectorBarStream a(bars, 128), b(bars, 128);
+    two->fit_stream(a);
+    restored->fit_stream(b);
+    CHECK(two->predict(probe) == restored->predict(probe));
+    CHECK(one->predict(probe) != two->predict(probe));
+}
+
+int main() {
+    test_chunking_does_not_change_model();
+    test_decay_counts_passes();
+    return test_failures();
+}
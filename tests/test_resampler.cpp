@@ -0,0 +1,180 @@
+#include "TestUtil.hpp"
+#include "core/FeatureEngine.hpp"
+#include "core/Resampler.hpp"
+#include <map>
+
+using std::chrono::seconds;
+
+// Straightforward grouping by bucket start, for comparison.
+static std::vector<Bar> brute_force(const std::vector<Bar>& bars, seconds interval, seconds offset) {
+    std::map<long long, std::vector<const Bar*>> groups;
+    for (const auto& b : bars) {
+        long long t = std::chrono::duration_cast<seconds>(b.timestamp.time_since_epoch()).count()
+                      - offset.count();
+        long long q = t / interval.count();
+        if (t % interval.count() < 0) --q;
+        groups[q].push_back(&b);
+    }
+
+    std::vector<Bar> out;
+    for (const auto& [q, group] : groups) {
+        Bar r = *group.front();
+        r.timestamp = std::chrono::system_clock::time_point{q * interval + offset};
+        r.volume = 0;
+        for (const Bar* b : group) {
+            r.high = std::max(r.high, b->high);
+            r.low = std::min(r.low, b->low);
+            r.close = b->close;
+            r.volume += b->volume;
+        }
+        out.push_back(r);
+    }
+    return out;
+}
+
+static bool same_bars(const std::vector<Bar>& a, const std::vector<Bar>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].timestamp != b[i].timestamp || a[i].open != b[i].open ||
+            a[i].high != b[i].high || a[i].low != b[i].low ||
+            a[i].close != b[i].close || a[i].volume != b[i].volume) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Minute bars with a gap, starting mid-bucket.
+static std::vector<Bar> gappy_bars() {
+    auto start = std::chrono::system_clock::time_point{seconds{7 * 60}};
+    auto bars = make_bars(1000, "AAA", 100.0, 21, seconds{60}, start);
+    bars.erase(bars.begin() + 300, bars.begin() + 420);
+    return bars;
+}
+
+static void test_matches_brute_force() {
+    auto bars = gappy_bars();
+    Resampler r(seconds{60}, {seconds{300}, seconds{3600}}, seconds{120});
+    for (const auto& b : bars) r.update(b);
+    r.flush();
+
+    CHECK(same_bars(r.series()[0].bars, brute_force(bars, seconds{300}, seconds{120})));
+    CHECK(same_bars(r.series()[1].bars, brute_force(bars, seconds{3600}, seconds{120})));
+}
+
+// The static form drops the unfinished last bucket.
+static void test_static_drops_trailing_partial() {
+    auto bars = make_bars(130, "AAA", 100.0, 22);
+    auto series = Resampler::resample(bars, seconds{60}, {seconds{3600}});
+    CHECK(series[0].bars.size() == 2);
+    CHECK(same_bars(series[0].bars, brute_force(std::vector<Bar>(bars.begin(), bars.begin() + 120),
+                                                seconds{3600}, seconds{0})));
+}
+
+// A base bar may only see higher bars whose bucket ended by its own end.
+static void test_no_lookahead() {
+    auto bars = gappy_bars();
+    auto series = Resampler::resample(bars, seconds{60}, {seconds{300}, seconds{900}});
+    for (const auto& s : series) {
+        CHECK(s.align.size() == bars.size());
+        for (std::size_t i = 0; i < bars.size(); ++i) {
+            std::size_t j = s.align[i];
+            if (j == ResampledSeries::npos) continue;
+            CHECK(s.bars[j].timestamp + s.interval <= bars[i].timestamp + seconds{60});
+            CHECK(j + 1 == s.bars.size() ||
+                  s.bars[j + 1].timestamp + s.interval > bars[i].timestamp + seconds{60});
+        }
+    }
+}
+
+static void test_live_counts_and_discard() {
+    auto bars = gappy_bars();
+    Resampler live(seconds{60}, {seconds{300}});
+    auto whole = Resampler::resample(bars, seconds{60}, {seconds{300}});
+
+    std::vector<Bar> emitted;
+    for (const auto& b : bars) {
+        std::size_t n = live.update(b)[0];
+        const auto& out = live.series()[0].bars;
+        CHECK(n <= 1 && out.size() >= n);
+        emitted.insert(emitted.end(), out.end() - n, out.end());
+        live.discard_emitted();
+        CHECK(live.series()[0].bars.size() <= 1);
+        CHECK(live.series()[0].align.empty());
+    }
+    CHECK(same_bars(emitted, whole[0].bars));
+
+    // The retained bar keeps alignment meaningful after a discard.
+    Bar next = bars.back();
+    next.timestamp += seconds{60};
+    live.update(next);
+    CHECK(live.series()[0].align.back() == 0);
+}
+
+static void test_symbol_change() {
+    auto a = make_bars(100, "AAA", 100.0, 23);
+    auto b = make_bars(3, "BBB", 50.0, 24, seconds{60}, a.back().timestamp + seconds{60});
+    Resampler r(seconds{60}, {seconds{300}});
+    for (const auto& bar : a) r.update(bar);
+    CHECK(r.update(b.front())[0] == 0);  // AAA's last bucket closed on the 100th bar
+    CHECK(r.series()[0].align.back() == ResampledSeries::npos);
+}
+
+// A resent bar inside an open bucket must not be merged twice, and is
+// rejected the same way as one at a bucket boundary.
+static void test_rejects_repeated_bars() {
+    auto bars = make_bars(20, "AAA", 100.0, 25);
+    Resampler r(seconds{60}, {seconds{300}});
+    for (std::size_t i = 0; i < 7; ++i) r.update(bars[i]);
+    CHECK_THROWS(r.update(bars[6]));   // mid-bucket duplicate
+    CHECK_THROWS(r.update(bars[5]));   // late bar
+    for (std::size_t i = 7; i < 10; ++i) r.update(bars[i]);
+    CHECK_THROWS(r.update(bars[9]));   // duplicate that closed a bucket
+    for (std::size_t i = 10; i < bars.size(); ++i) r.update(bars[i]);
+
+    CHECK(same_bars(r.series()[0].bars, brute_force(bars, seconds{300}, seconds{0})));
+    CHECK(r.series()[0].align.size() == bars.size());
+
+    // A new symbol may start at any time.
+    auto other = make_bars(3, "BBB", 50.0, 26);
+    r.update(other.front());
+}
+
+static void test_rejects_bad_config() {
+    CHECK_THROWS(Resampler(seconds{60}, {seconds{300}, seconds{300}}));
+    CHECK_THROWS(Resampler(seconds{60}, {seconds{90}}));
+    CHECK_THROWS(Resampler(seconds{60}, {seconds{300}}, seconds{30}));
+    CHECK_THROWS(Resampler(seconds{0}, {seconds{300}}));
+    Resampler ok(seconds{60}, {seconds{300}}, seconds{-120});
+    (void)ok;
+}
+
+// The lookup view agrees with the materialised join.
+static void test_aligned_view_matches_join() {
+    auto bars = gappy_bars();
+    auto series = Resampler::resample(bars, seconds{60}, {seconds{900}});
+    auto higher = FeatureEngine::make_features(series[0].bars);
+    auto base = FeatureEngine::make_features(bars);
+    FeatureEngine::join_timeframe(base, series[0], higher, "h_");
+
+    AlignedFeatures view(series[0], higher);
+    CHECK(view.size() == base.size());
+    for (std::size_t i = 0; i < base.size(); ++i) {
+        const FeatureRow* h = view.at(i);
+        CHECK((h == nullptr) == (series[0].align[i] == ResampledSeries::npos));
+        double joined = base[i].values.at("h_ema12");
+        CHECK(h ? same_value(h->values.at("ema12"), joined) : std::isnan(joined));
+    }
+}
+
+int main() {
+    test_matches_brute_force();
+    test_static_drops_trailing_partial();
+    test_no_lookahead();
+    test_live_counts_and_discard();
+    test_symbol_change();
+    test_rejects_repeated_bars();
+    test_rejects_bad_config();
+    test_aligned_view_matches_join();
+    return test_failures();
+}
@@ -0,0 +1,70 @@
+#include "TestUtil.hpp"
+#include "models/RidgeModel.hpp"
+
+// BTC-scale prices make the raw Gram matrix hopelessly ill-conditioned;
+// training and prediction must still succeed and track the price.
+static void test_large_scale_is_stable() {
+    auto bars = make_bars(20000, "BTC", 60000.0, 5);
+    for (double lambda : {1.0, 1e-3, 0.0}) {
+        RidgeModel model(lambda);
+        VectorBarStream stream(bars, 4096);
+        model.fit_stream(stream);
+
+        double err = 0;
+        for (std::size_t i = 100; i + 1 < bars.size(); i += 97) {
+            auto rows = FeatureEngine::make_features(
+                std::vector<Bar>(bars.begin() + i - 99, bars.begin() + i + 1));
+            double p = model.predict(rows.back());
+            CHECK(std::isfinite(p));
+            err = std::max(err, std::fabs(p - bars[i + 1].close) / bars[i + 1].close);
+        }
+        CHECK(err < 0.02);
+    }
+}
+
+// Accumulating in chunks gives the same model as one batch fit.
+static void test_partial_fit_matches_fit() {
+    auto bars = make_bars(3000, "AAA", 100.0, 6);
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    training_set(bars, X, y);
+
+    RidgeModel batch(0.5);
+    batch.fit(X, y);
+
+    RidgeModel chunked(0.5);
+    for (std::size_t i = 0; i < X.size(); i += 250) {
+        std::size_t end = std::min(i + 250, X.size());
+        chunked.partial_fit(std::vector<FeatureRow>(X.begin() + i, X.begin() + end),
+                            std::vector<double>(y.begin() + i, y.begin() + end));
+    }
+
+    for (std::size_t i = 0; i < X.size(); i += 101) {
+        double a = batch.predict(X[i]);
+        double b = chunked.predict(X[i]);
+        CHECK(std::fabs(a - b) <= 1e-6 * std::fabs(a));
+    }
+}
+
+// A bad batch is rejected before it touches the accumulators.
+static void test_rejected_batch_leaves_model_intact() {
+    auto bars = make_bars(500, "AAA", 100.0, 7);
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    training_set(bars, X, y);
+
+    RidgeModel model;
+    model.fit(X, y);
+    double before = model.predict(X[200]);
+
+    std::vector<double> short_y(y.begin(), y.end() - 1);
+    CHECK_THROWS(model.partial_fit(X, short_y));
+    CHECK(model.predict(X[200]) == before);
+}
+
+int main() {
+    test_large_scale_is_stable();
+    test_partial_fit_matches_fit();
+    test_rejected_batch_leaves_model_intact();
+    return test_failures();
+}
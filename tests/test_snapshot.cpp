@@ -0,0 +1,116 @@
+#include "TestUtil.hpp"
+#include "models/LinearModel.hpp"
+#include "models/OnlineBoost.hpp"
+#include "models/RegimeSwitch.hpp"
+#include "models/RidgeModel.hpp"
+#include <cstdio>
+#include <filesystem>
+
+static std::unique_ptr<BaseModel> round_trip(const BaseModel& model) {
+    SnapshotWriter w;
+    model.save(w);
+    const auto& bytes = w.finish();
+    SnapshotReader r(bytes.data(), bytes.size());
+    return BaseModel::load(r);
+}
+
+static bool same_predictions(const BaseModel& a, const BaseModel& b,
+                             const std::vector<FeatureRow>& X) {
+    for (const auto& row : X) {
+        if (!same_value(a.predict(row), b.predict(row))) return false;
+    }
+    return true;
+}
+
+static void test_round_trips() {
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    training_set(make_bars(400, "AAA", 100.0, 11), X, y, 100);
+
+    std::vector<std::unique_ptr<BaseModel>> models;
+    models.push_back(std::make_unique<LinearModel>(1e-6, 5));
+    models.push_back(std::make_unique<OnlineBoost>(3, 1e-6, 0.1));
+    models.push_back(std::make_unique<RidgeModel>(0.5));
+    models.push_back(std::make_unique<RegimeSwitch>(std::make_unique<RidgeModel>(1.0),
+                                                    std::make_unique<LinearModel>(1e-6, 5)));
+    for (auto& model : models) {
+        model->fit(X, y);
+        auto copy = round_trip(*model);
+        CHECK(same_predictions(*model, *copy, X));
+    }
+
+    // Untrained models have no weights and no names, and must still load.
+    LinearModel empty;
+    CHECK(round_trip(empty) != nullptr);
+    RidgeModel empty_ridge;
+    CHECK(round_trip(empty_ridge) != nullptr);
+}
+
+static void test_file_round_trip() {
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    training_set(make_bars(400, "AAA", 100.0, 11), X, y, 100);
+    RidgeModel model;
+    model.fit(X, y);
+
+    auto path = (std::filesystem::temp_directory_path() / "la_test_snapshot.bin").string();
+    model.save(path);
+    model.save(path);  // replaces the existing file
+    auto loaded = BaseModel::load(path);
+    CHECK(same_predictions(model, *loaded, X));
+
+    auto dir = std::filesystem::path(path).parent_path();
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        CHECK(entry.path().filename().string().rfind("la_test_snapshot.bin.tmp", 0) != 0);
+    }
+    std::filesystem::remove(path);
+
+    CHECK_THROWS(model.save((std::filesystem::path(path) / "missing" / "x.bin").string()));
+}
+
+static std::unique_ptr<BaseModel> load_linear_record(const std::vector<double>& weights,
+                                                     const std::vector<std::string>& names) {
+    SnapshotWriter w;
+    w.begin_record(static_cast<std::uint32_t>(ModelType::Linear));
+    w.write(LinearModel::SnapshotParams{0.01, 0.0, 0.0, 1, 0, weights.size(), 0});
+    w.write_array(weights.data(), weights.size());
+    w.write_strings(names);
+    w.end_record();
+    const auto& bytes = w.finish();
+    SnapshotReader r(bytes.data(), bytes.size());
+    return BaseModel::load(r);
+}
+
+// Weights must be empty together with the names, or one per name plus
+// the intercept.
+static void test_rejects_mismatched_linear_record() {
+    CHECK(load_linear_record({}, {}) != nullptr);
+    CHECK(load_linear_record({0.5, 1.0}, {"ret_1"}) != nullptr);
+
+    const char* mismatch = "Corrupt LinearModel snapshot: weight count mismatch";
+    CHECK_THROWS_WITH(load_linear_record({}, {"ret_1"}), mismatch);
+    CHECK_THROWS_WITH(load_linear_record({0.5, 1.0}, {}), mismatch);
+    CHECK_THROWS_WITH(load_linear_record({0.5, 1.0}, {"ret_1", "ret_5"}), mismatch);
+}
+
+static void test_rejects_truncation() {
+    std::vector<FeatureRow> X;
+    std::vector<double> y;
+    training_set(make_bars(400, "AAA", 100.0, 11), X, y, 100);
+    LinearModel model(1e-6, 5);
+    model.fit(X, y);
+
+    SnapshotWriter w;
+    model.save(w);
+    auto bytes = w.finish();
+    bytes.resize(bytes.size() - 8);
+    CHECK_THROWS(SnapshotReader(bytes.data(), bytes.size()));
+}
+
+int main() {
+    test_round_trips();
+    test_file_round_trip();
+    test_rejects_mismatched_linear_record();
+    test_rejects_truncation();
+    return test_failures();
+}